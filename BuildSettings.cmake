@@ -3,4 +3,18 @@ if (APPLE)
     set(GAMEWINDOW_SYSTEM_DEFAULT GLFW)
 endif()
 
-set(GAMEWINDOW_SYSTEM ${GAMEWINDOW_SYSTEM_DEFAULT} CACHE STRING "The implementation to use for windows - EGLUT or GLFW")
\ No newline at end of file
+set(GAMEWINDOW_SYSTEM ${GAMEWINDOW_SYSTEM_DEFAULT} CACHE STRING "The implementation to use for windows - EGLUT, GLFW, SDL3 or PLUGIN")
+
+set(GAMEWINDOW_PLUGINS_DEFAULT GLFW EGLUT)
+if (APPLE)
+    set(GAMEWINDOW_PLUGINS_DEFAULT GLFW)
+endif()
+
+# Backend modules built with GAMEWINDOW_SYSTEM=PLUGIN, the order is the default probe order (overridden by $GAMEWINDOW_BACKENDS)
+set(GAMEWINDOW_PLUGINS ${GAMEWINDOW_PLUGINS_DEFAULT} CACHE STRING "The backend modules to build for PLUGIN - EGLUT, GLFW and/or SDL3")
+
+# Exposes the backend as final concrete types through game_window_native.h, only for single backend builds
+option(GAMEWINDOW_STATIC_DISPATCH "Expose the selected backend as concrete types and build with LTO" OFF)
+
+# Steady state allocation test, run with ctest
+option(GAMEWINDOW_BUILD_TESTS "Build the tests" OFF)
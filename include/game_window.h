@@ -3,10 +3,15 @@
 #include <string>
 #include <functional>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include "key_mapping.h"
+#include "game_window_trace.h"
 
 enum class GraphicsApi {
-    OPENGL, OPENGL_ES2
+    OPENGL, OPENGL_ES2,
+    // No GL context is created, see GameWindow::createVulkanSurface. swapBuffers only marks the presented frame
+    VULKAN
 };
 enum class KeyAction {
     PRESS, REPEAT, RELEASE
@@ -23,9 +28,105 @@ enum class GamepadAxisId {
     LEFT_X, LEFT_Y, RIGHT_X, RIGHT_Y, LEFT_TRIGGER, RIGHT_TRIGGER,
     UNKNOWN = -1
 };
+enum class FullscreenType {
+    // Switches the video mode of the monitor, see setFullscreenMode
+    EXCLUSIVE,
+    // Covers the monitor using the desktop video mode, no modeset
+    BORDERLESS
+};
 struct FullscreenMode {
     int id = 0;
+    // Only filled for modes returned to the application, compare the numeric fields instead
     std::string description;
+    int width = 0, height = 0;
+    float refreshRate = 0.0f;
+    float pixelDensity = 1.0f;
+
+    bool sameMode(FullscreenMode const& other) const {
+        return width == other.width && height == other.height && refreshRate == other.refreshRate &&
+               pixelDensity == other.pixelDensity;
+    }
+};
+struct MonitorInfo {
+    int id = -1;
+    std::string name;
+    // Position and size in desktop coordinates
+    int x = 0, y = 0, width = 0, height = 0;
+    float refreshRate = 0.0f;
+    float scale = 1.0f;
+    bool primary = false;
+};
+
+struct ContextConfig {
+    // Bits per channel, 0 requests no buffer
+    int redBits = 8, greenBits = 8, blueBits = 8, alphaBits = 8;
+    int depthBits = 24, stencilBits = 8;
+    // MSAA samples of the default framebuffer, 0 disables multisampling
+    int samples = 0;
+    bool srgb = false;
+    // KHR_no_error, skips the driver validation. Ignored together with debug or robustness
+    bool noError = false;
+    bool debug = false;
+    // Forwards KHR_debug messages of the driver, like performance warnings, as DiagnosticCode::GL_DEBUG.
+    // Requests a debug context, false in getContextConfig if the context has no debug output
+    bool debugOutput = false;
+    // Robust buffer access, the context is lost on a gpu reset
+    bool robustness = false;
+};
+enum class EventCategory {
+    WINDOW, MOUSE, TOUCH, KEYBOARD, TEXT, GAMEPAD, COUNT
+};
+struct GameWindowStats {
+    // Events dispatched since the window was created
+    uint64_t events[(int) EventCategory::COUNT] = {};
+    // Rate over the last full second, updated by pollEvents
+    float eventsPerSecond[(int) EventCategory::COUNT] = {};
+    // Events dispatched while no callback was set
+    uint64_t skippedCallbacks = 0;
+    uint64_t pollEventsCalls = 0;
+    double pollEventsTotalMs = 0.0, pollEventsMaxMs = 0.0;
+    // Time spent in swapBuffers, including waiting for vsync
+    uint64_t swapBuffersCalls = 0;
+    double swapBuffersTotalMs = 0.0, swapBuffersMaxMs = 0.0;
+    uint64_t gamepadPolls = 0;
+    // Connected joysticks without a gamepad mapping, counted on the focused window only
+    uint64_t gamepadMappingMisses = 0;
+    // Clipboard transfers through the window system
+    uint64_t clipboardRoundTrips = 0;
+    // Time the application spent on a frame, from the end of one swapBuffers to the start of the next
+    uint64_t cpuFrames = 0;
+    double cpuFrameTotalMs = 0.0, cpuFrameMaxMs = 0.0;
+    // GPU time between the same points, see GameWindow::setGpuTimingEnabled. Lags a few frames behind
+    uint64_t gpuFrames = 0;
+    double gpuFrameTotalMs = 0.0, gpuFrameMaxMs = 0.0;
+    // CPU time of the frames counted in gpuFrames, a host is GPU bound if gpuFrameTotalMs is larger
+    double gpuFramesCpuTotalMs = 0.0;
+};
+
+struct WindowOptions {
+    // Create the window fullscreen instead of calling setFullscreen after creation
+    bool fullscreen = false;
+    FullscreenType fullscreenType = FullscreenType::EXCLUSIVE;
+    // Monitor id, see GameWindowManager::getMonitors, -1 uses the primary monitor
+    int monitor = -1;
+    // Used with FullscreenType::EXCLUSIVE, id -1 keeps the desktop video mode
+    FullscreenMode mode = { -1 };
+    // show() is deferred until the first frame was swapped
+    bool hiddenUntilFirstFrame = false;
+    ContextConfig context;
+};
+
+// Context sharing objects with a window context, for uploading resources on worker threads
+class GpuFrameTimer;
+
+class GameWindowContext {
+
+public:
+    virtual ~GameWindowContext() {}
+
+    // Makes the context current on the calling thread, false releases it
+    virtual void makeCurrent(bool active) = 0;
+
 };
 
 class GameWindow {
@@ -46,6 +147,7 @@ public:
     using GamepadButtonCallback = std::function<void (int, GamepadButtonId, bool)>;
     using GamepadAxisCallback = std::function<void (int, GamepadAxisId, float)>;
     using CloseCallback = std::function<void ()>;
+    using FullscreenCallback = std::function<void (bool)>;
 
 private:
     DrawCallback drawCallback;
@@ -63,12 +165,24 @@ private:
     GamepadButtonCallback gamepadButtonCallback;
     GamepadAxisCallback gamepadAxisCallback;
     CloseCallback closeCallback;
+    FullscreenCallback fullscreenCallback;
+    uint64_t gamepadEventTimeNs = 0;
+
+    GraphicsApi graphicsApi;
+    std::atomic<bool> gpuTimingEnabled {false};
+    // Only used by the thread calling swapBuffers
+    std::unique_ptr<GpuFrameTimer> gpuTimer;
+    bool gpuTimingUnsupported = false;
+    uint64_t frameStartNs = 0;
+
+    void beginSwap();
+    void endSwap();
 
 public:
 
-    GameWindow(std::string const& title, int width, int height, GraphicsApi api) {}
+    GameWindow(std::string const& title, int width, int height, GraphicsApi api);
 
-    virtual ~GameWindow() {}
+    virtual ~GameWindow();
 
     virtual void makeCurrent(bool) = 0;
 
@@ -111,6 +225,49 @@ public:
         return {};
     }
 
+    virtual void setFullscreenType(FullscreenType type) {}
+
+    virtual FullscreenType getFullscreenType() {
+        return FullscreenType::EXCLUSIVE;
+    }
+
+    // Creates a context sharing textures, buffers and shaders with the window context, nullptr if unsupported.
+    // Call from the thread which created the window, destroy the shared contexts before the window
+    virtual std::shared_ptr<GameWindowContext> createSharedContext() {
+        return nullptr;
+    }
+
+    // Creates a VkSurfaceKHR for the VkInstance of the application, windows have to use GraphicsApi::VULKAN.
+    // Returns VK_NULL_HANDLE on failure, the vulkan types are passed as opaque handles
+    virtual uint64_t createVulkanSurface(void* instance) {
+        return 0;
+    }
+
+    // Configuration of the context and default framebuffer actually granted, may differ from the requested one
+    virtual ContextConfig getContextConfig() {
+        return ContextConfig();
+    }
+
+    // Id of the monitor the window is on, see GameWindowManager::getMonitors
+    virtual int getMonitor() {
+        return -1;
+    }
+
+    // Monitor used by setFullscreen and getFullscreenModes, -1 uses the monitor the window is on
+    virtual void setFullscreenMonitor(int monitor) {}
+
+    // Refresh rate of the monitor the window is on, 0 if unknown
+    virtual float getRefreshRate() {
+        return 0.0f;
+    }
+
+    // Counters of the window, readable from any thread. See GameWindowManager::getStats for all windows
+    GameWindowStats getStats() const;
+
+    // Measures the GPU time of each frame with timer queries, see GameWindowStats::gpuFrames.
+    // Takes effect with the next swapBuffers, GraphicsApi::VULKAN windows only report the CPU time
+    void setGpuTimingEnabled(bool enabled) { gpuTimingEnabled = enabled; }
+
     void setDrawCallback(DrawCallback callback) { drawCallback = std::move(callback); }
 
     void setWindowSizeCallback(WindowSizeCallback callback) { windowSizeCallback = std::move(callback); }
@@ -136,6 +293,10 @@ public:
     // Used when the cursor is disabled
     void setMouseRelativePositionCallback(MousePositionCallback callback) { mouseRelativePositionCallback = std::move(callback); }
 
+    // Sample time of the gamepad event being dispatched in GameWindowTrace::now() nanoseconds, for use in the gamepad callbacks.
+    // Backends without a sampling thread report the time the event was polled
+    uint64_t getGamepadEventTime() const { return gamepadEventTimeNs; }
+
     void setGamepadStateCallback(GamepadStateCallback callback) { gamepadStateCallback = std::move(callback); }
 
     void setGamepadButtonCallback(GamepadButtonCallback callback) { gamepadButtonCallback = std::move(callback); }
@@ -144,72 +305,203 @@ public:
 
     void setCloseCallback(CloseCallback callback) { closeCallback = std::move(callback); }
 
+    // Called once a setFullscreen request completed, setFullscreen only queues the transition
+    void setFullscreenCallback(FullscreenCallback callback) { fullscreenCallback = std::move(callback); }
+
 
 protected:
 
+    // Relaxed atomics, the backends update them from the event, render and gamepad threads
+    struct StatsCounters {
+        std::atomic<uint64_t> events[(int) EventCategory::COUNT] {};
+        std::atomic<float> eventsPerSecond[(int) EventCategory::COUNT] {};
+        std::atomic<uint64_t> skippedCallbacks {0};
+        std::atomic<uint64_t> pollEventsCalls {0}, pollEventsTotalNs {0}, pollEventsMaxNs {0};
+        std::atomic<uint64_t> swapBuffersCalls {0}, swapBuffersTotalNs {0}, swapBuffersMaxNs {0};
+        std::atomic<uint64_t> gamepadPolls {0}, gamepadMappingMisses {0}, clipboardRoundTrips {0};
+        std::atomic<uint64_t> cpuFrames {0}, cpuFrameTotalNs {0}, cpuFrameMaxNs {0};
+        std::atomic<uint64_t> gpuFrames {0}, gpuFrameTotalNs {0}, gpuFrameMaxNs {0}, gpuFramesCpuTotalNs {0};
+        // Start of the current rate interval, only used by the pollEvents thread
+        uint64_t rateStartNs = 0;
+        uint64_t rateStartEvents[(int) EventCategory::COUNT] = {};
+
+        static void increment(std::atomic<uint64_t>& counter) {
+            counter.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    StatsCounters stats;
+
+    enum class TimedStat {
+        POLL_EVENTS, SWAP_BUFFERS
+    };
+
+    // Measures pollEvents or swapBuffers of the backend
+    class StatsTimer {
+        GameWindow& window;
+        TimedStat stat;
+        uint64_t start;
+
+    public:
+        StatsTimer(GameWindow& window, TimedStat stat) : window(window), stat(stat), start(GameWindowTrace::now()) {}
+
+        StatsTimer(StatsTimer const&) = delete;
+        StatsTimer& operator=(StatsTimer const&) = delete;
+
+        ~StatsTimer() {
+            window.recordTime(stat, start, GameWindowTrace::now());
+        }
+    };
+
+    void recordTime(TimedStat stat, uint64_t startNs, uint64_t endNs);
+
+    // Wraps the buffer swap of the backend with the frame time measurements, the context has to be current
+    class FrameTimer {
+        GameWindow& window;
+
+    public:
+        explicit FrameTimer(GameWindow& window) : window(window) {
+            window.beginSwap();
+        }
+
+        FrameTimer(FrameTimer const&) = delete;
+        FrameTimer& operator=(FrameTimer const&) = delete;
+
+        ~FrameTimer() {
+            window.endSwap();
+        }
+    };
+
+    void countEvent(EventCategory category, bool handled) {
+        StatsCounters::increment(stats.events[(int) category]);
+        if (!handled)
+            StatsCounters::increment(stats.skippedCallbacks);
+    }
+
+    // Gamepad support is only initialized once a window wants gamepad events
+    bool hasGamepadCallbacks() const {
+        return gamepadStateCallback != nullptr || gamepadButtonCallback != nullptr || gamepadAxisCallback != nullptr;
+    }
+
     void onDraw() {
-        if (drawCallback != nullptr)
+        if (drawCallback != nullptr) {
+            GameWindowTrace::Scope trace("onDraw");
             drawCallback();
+        }
     }
     void onWindowSizeChanged(int w, int h) {
-        if (windowSizeCallback != nullptr)
+        countEvent(EventCategory::WINDOW, windowSizeCallback != nullptr);
+        if (windowSizeCallback != nullptr) {
+            GameWindowTrace::Scope trace("onWindowSizeChanged");
             windowSizeCallback(w, h);
+        }
     }
     void onMouseButton(double x, double y, int button, MouseButtonAction action) {
-        if (mouseButtonCallback != nullptr)
+        countEvent(EventCategory::MOUSE, mouseButtonCallback != nullptr);
+        if (mouseButtonCallback != nullptr) {
+            GameWindowTrace::Scope trace("onMouseButton");
             mouseButtonCallback(x, y, button, action);
+        }
     }
     void onMousePosition(double x, double y) {
-        if (mousePositionCallback != nullptr)
+        countEvent(EventCategory::MOUSE, mousePositionCallback != nullptr);
+        if (mousePositionCallback != nullptr) {
+            GameWindowTrace::Scope trace("onMousePosition");
             mousePositionCallback(x, y);
+        }
     }
     void onMouseRelativePosition(double x, double y) {
-        if (mouseRelativePositionCallback != nullptr)
+        countEvent(EventCategory::MOUSE, mouseRelativePositionCallback != nullptr);
+        if (mouseRelativePositionCallback != nullptr) {
+            GameWindowTrace::Scope trace("onMouseRelativePosition");
             mouseRelativePositionCallback(x, y);
+        }
     }
     void onMouseScroll(double x, double y, double dx, double dy) {
-        if (mouseScrollCallback != nullptr)
+        countEvent(EventCategory::MOUSE, mouseScrollCallback != nullptr);
+        if (mouseScrollCallback != nullptr) {
+            GameWindowTrace::Scope trace("onMouseScroll");
             mouseScrollCallback(x, y, dx, dy);
+        }
     }
     void onTouchStart(int id, double x, double y) {
-        if (touchStartCallback != nullptr)
+        countEvent(EventCategory::TOUCH, touchStartCallback != nullptr);
+        if (touchStartCallback != nullptr) {
+            GameWindowTrace::Scope trace("onTouchStart");
             touchStartCallback(id, x, y);
+        }
     }
     void onTouchUpdate(int id, double x, double y) {
-        if (touchUpdateCallback != nullptr)
+        countEvent(EventCategory::TOUCH, touchUpdateCallback != nullptr);
+        if (touchUpdateCallback != nullptr) {
+            GameWindowTrace::Scope trace("onTouchUpdate");
             touchUpdateCallback(id, x, y);
+        }
     }
     void onTouchEnd(int id, double x, double y) {
-        if (touchEndCallback != nullptr)
+        countEvent(EventCategory::TOUCH, touchEndCallback != nullptr);
+        if (touchEndCallback != nullptr) {
+            GameWindowTrace::Scope trace("onTouchEnd");
             touchEndCallback(id, x, y);
+        }
     }
     void onKeyboard(KeyCode key, KeyAction action) {
-        if (keyboardCallback != nullptr)
+        countEvent(EventCategory::KEYBOARD, keyboardCallback != nullptr);
+        if (keyboardCallback != nullptr) {
+            GameWindowTrace::Scope trace("onKeyboard");
             keyboardCallback(key, action);
+        }
     }
     void onKeyboardText(std::string const& c) {
-        if (keyboardTextCallback != nullptr)
+        countEvent(EventCategory::TEXT, keyboardTextCallback != nullptr);
+        if (keyboardTextCallback != nullptr) {
+            GameWindowTrace::Scope trace("onKeyboardText");
             keyboardTextCallback(c);
+        }
     }
     void onPaste(std::string const& c) {
-        if (pasteCallback != nullptr)
+        countEvent(EventCategory::TEXT, pasteCallback != nullptr);
+        if (pasteCallback != nullptr) {
+            GameWindowTrace::Scope trace("onPaste");
             pasteCallback(c);
+        }
     }
-    void onGamepadState(int id, bool connected) {
-        if (gamepadStateCallback != nullptr)
+    void onGamepadState(int id, bool connected, uint64_t timeNs = 0) {
+        countEvent(EventCategory::GAMEPAD, gamepadStateCallback != nullptr);
+        if (gamepadStateCallback != nullptr) {
+            gamepadEventTimeNs = timeNs != 0 ? timeNs : GameWindowTrace::now();
+            GameWindowTrace::Scope trace("onGamepadState");
             gamepadStateCallback(id, connected);
+        }
     }
-    void onGamepadButton(int id, GamepadButtonId btn, bool pressed) {
-        if (gamepadButtonCallback != nullptr)
+    void onGamepadButton(int id, GamepadButtonId btn, bool pressed, uint64_t timeNs = 0) {
+        countEvent(EventCategory::GAMEPAD, gamepadButtonCallback != nullptr);
+        if (gamepadButtonCallback != nullptr) {
+            gamepadEventTimeNs = timeNs != 0 ? timeNs : GameWindowTrace::now();
+            GameWindowTrace::Scope trace("onGamepadButton");
             gamepadButtonCallback(id, btn, pressed);
+        }
     }
-    void onGamepadAxis(int id, GamepadAxisId axis, float val) {
-        if (gamepadAxisCallback != nullptr)
+    void onGamepadAxis(int id, GamepadAxisId axis, float val, uint64_t timeNs = 0) {
+        countEvent(EventCategory::GAMEPAD, gamepadAxisCallback != nullptr);
+        if (gamepadAxisCallback != nullptr) {
+            gamepadEventTimeNs = timeNs != 0 ? timeNs : GameWindowTrace::now();
+            GameWindowTrace::Scope trace("onGamepadAxis");
             gamepadAxisCallback(id, axis, val);
+        }
     }
     void onClose() {
-        if (closeCallback != nullptr)
+        countEvent(EventCategory::WINDOW, closeCallback != nullptr);
+        if (closeCallback != nullptr) {
+            GameWindowTrace::Scope trace("onClose");
             closeCallback();
+        }
+    }
+    void onFullscreenChanged(bool fullscreen) {
+        countEvent(EventCategory::WINDOW, fullscreenCallback != nullptr);
+        if (fullscreenCallback != nullptr) {
+            GameWindowTrace::Scope trace("onFullscreenChanged");
+            fullscreenCallback(fullscreen);
+        }
     }
 
 };
@@ -1,8 +1,36 @@
 #pragma once
 #include <string>
+#include <cstdint>
+
+enum class DiagnosticSeverity {
+    // FAILURE instead of ERROR, which is a macro on some platforms
+    VERBOSE, INFO, WARNING, FAILURE
+};
+enum class DiagnosticCode {
+    GENERIC, UNKNOWN_KEY, MISSING_GAMEPAD_MAPPING, THREAD_OPTIONS, SHARED_CONTEXT, VULKAN_SURFACE, HITCH, GPU_TIMING, GL_DEBUG,
+    COUNT
+};
+
+struct GameWindowDiagnostic {
+    DiagnosticCode code = DiagnosticCode::GENERIC;
+    DiagnosticSeverity severity = DiagnosticSeverity::INFO;
+    std::string source;
+    std::string message;
+    // CLOCK_MONOTONIC nanoseconds of the report, the delivery happens later
+    uint64_t timeNs = 0;
+    // Reports of the same code dropped by the rate limit since the last delivered one
+    uint32_t suppressed = 0;
+    // Reports of any code dropped because the queue was full
+    uint32_t dropped = 0;
+};
 
 class GameWindowErrorHandler {
 
 public:
+    // Runs on the diagnostics thread for the reports forwarded by onDiagnostic, not on the thread which
+    // hit the error. Overrides have to be thread safe and must not call back into the window
     virtual bool onError(std::string title, std::string errormsg);
-};
\ No newline at end of file
+
+    // Called on the diagnostics thread, see GameWindowManager::setDiagnosticRateLimit. Forwards to onError by default
+    virtual void onDiagnostic(GameWindowDiagnostic const& diagnostic);
+};
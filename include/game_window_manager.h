@@ -2,9 +2,30 @@
 
 #include "game_window.h"
 #include "game_window_error_handler.h"
+#include "game_window_thread.h"
 #include <memory>
-
-class GameWindowManager {
+#include <future>
+#include <cstdint>
+
+struct StartupTiming {
+    std::string name;
+    // Milliseconds since the library was loaded
+    double startMs = 0.0;
+    double durationMs = 0.0;
+    // Kernel thread id the span ran on, spans of different threads overlap
+    uint64_t threadId = 0;
+};
+
+struct WatchdogOptions {
+    // Callback dispatches, swapBuffers and pollEvents calls taking longer are reported, 0 disables the watchdog
+    double thresholdMs = 0.0;
+    // Hitches within the interval after a report are only counted and summarized by the next report
+    double minReportIntervalMs = 1000.0;
+    // Backtrace of the thread when the slow call returned, which shows who dispatched it
+    bool captureBacktrace = false;
+};
+
+class GameWindowManager : public std::enable_shared_from_this<GameWindowManager> {
 
 private:
     static std::shared_ptr<GameWindowManager> instance;
@@ -14,7 +35,7 @@ private:
     std::shared_ptr<GameWindowErrorHandler> errorhandler;
 
 public:
-    GameWindowManager() : errorhandler(std::make_shared<GameWindowErrorHandler>()) {}
+    GameWindowManager();
 
     static std::shared_ptr<GameWindowManager> getManager();
 
@@ -25,20 +46,92 @@ public:
 
     virtual ProcAddrFunc getProcAddrFunc() = 0;
 
+    // Resolves count GL/EGL entry points into procs in one pass, missing entry points are set to nullptr.
+    // The results are shared by all windows of the api, a context of it has to be current the first time a name is resolved
+    void resolveProcs(GraphicsApi api, const char* const* names, AnyFunc* procs, size_t count);
+
+    // Whether the current context supports a GL or window system (EGL, GLX, WGL) extension.
+    // The extension strings are parsed once per api, later queries are a hash lookup
+    bool hasExtension(GraphicsApi api, const char* name);
+
+    // Uncached query of the window system extensions used by hasExtension
+    virtual bool isPlatformExtensionSupported(const char* name) {
+        return false;
+    }
+
+    std::shared_ptr<GameWindow>
+    createWindow(const std::string& title, int width, int height, GraphicsApi api) {
+        return createWindow(title, width, height, api, WindowOptions());
+    }
+
+    // The window surface is created once with the final size of the initial fullscreen state
     virtual std::shared_ptr<GameWindow>
-    createWindow(const std::string& title, int width, int height, GraphicsApi api) = 0;
+    createWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) = 0;
+
+    // One step of an incremental window creation, run on the thread owning the manager. Returns the window once
+    // created and nullptr if another step is needed, throws if the creation failed
+    using WindowCreationStep = std::function<std::shared_ptr<GameWindow>()>;
+
+    // Used by createWindowAsync, backends with a context fallback chain try one configuration per step.
+    // No window system calls are made before the first step, the default creates the window in one step
+    virtual WindowCreationStep
+    createWindowSteps(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options);
+
+    // Queues the window creation, the window system requires it to run on the thread owning the manager.
+    // Each runMainThreadTasks call runs one creation step, see createWindowSteps. The future becomes ready once
+    // the window was created and rethrows creation errors. Waiting on the future from the thread owning the
+    // manager before runMainThreadTasks finished the creation deadlocks, poll it with wait_for there instead.
+    // The manager has to be owned by a shared_ptr, like the one returned by getManager
+    std::future<std::shared_ptr<GameWindow>>
+    createWindowAsync(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options = {});
+
+    // Runs the work queued by createWindowAsync, call it from the thread which created the manager
+    void runMainThreadTasks();
+
+    // Instance extensions required by GameWindow::createVulkanSurface, empty if vulkan isn't supported
+    virtual std::vector<std::string> getVulkanInstanceExtensions() {
+        return {};
+    }
 
     virtual void addGamepadMappingFile(const std::string& path) = 0;
 
     virtual void addGamePadMapping(const std::string &content) = 0;
 
-    void setErrorHandler(std::shared_ptr<GameWindowErrorHandler> errorhandler) {
-        if (!errorhandler) {
-            this->errorhandler->onError("GameWindowManager", "errorhandler have to be an object");
-            return;
-        }
-        this->errorhandler = std::move(errorhandler);
+    virtual std::vector<MonitorInfo> getMonitors() {
+        return {};
     }
 
+    // Also receives the diagnostics, see GameWindowErrorHandler::onDiagnostic
+    void setErrorHandler(std::shared_ptr<GameWindowErrorHandler> errorhandler);
+
     const std::shared_ptr<GameWindowErrorHandler>& getErrorHandler() { return errorhandler; }
+
+    // Minimum time between two delivered diagnostics of a code, 0 delivers every report. Defaults to one second
+    void setDiagnosticRateLimit(DiagnosticCode code, double intervalMs);
+
+    // Waits until the diagnostics reported so far were delivered to the error handler
+    void flushDiagnostics();
+
+    // Scheduling policy, priority and cpu affinity applied to the threads driving the windows
+    void setThreadOptions(ThreadRole role, ThreadOptions options);
+
+    ThreadOptions getThreadOptions(ThreadRole role);
+
+    // Breakdown of the manager initialization and window creation
+    std::vector<StartupTiming> getStartupTimings();
+
+    // Writes the startup timings as Chrome trace JSON, done automatically after the first frame if $GAMEWINDOW_STARTUP_TRACE names a file
+    bool writeStartupTrace(std::string const& path);
+
+    // Sum of the counters of all windows, including destroyed ones
+    GameWindowStats getStats();
+
+    // Records pollEvents, the callbacks, swapBuffers, makeCurrent, lock waits and gamepad updates into per thread ring buffers
+    void setFrameTraceEnabled(bool enabled);
+
+    // Reports slow callbacks and blocking swaps through the error handler
+    void setWatchdogOptions(WatchdogOptions options);
+
+    // Writes the traced events of the last seconds as Chrome trace JSON, which ui.perfetto.dev imports
+    bool writeFrameTrace(std::string const& path, double seconds = 5.0);
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+// Concrete backend types for builds with GAMEWINDOW_STATIC_DISPATCH, calls through them are resolved at compile time
+#include "game_window_manager.h"
+
+#if defined(GAMEWINDOW_STATIC_DISPATCH_GLFW)
+#include <native/window_glfw.h>
+#include <native/window_manager_glfw.h>
+using NativeGameWindow = GLFWGameWindow;
+using NativeGameWindowManager = GLFWWindowManager;
+#elif defined(GAMEWINDOW_STATIC_DISPATCH_SDL3)
+#include <native/window_sdl3.h>
+#include <native/window_manager_sdl3.h>
+using NativeGameWindow = SDL3GameWindow;
+using NativeGameWindowManager = SDL3WindowManager;
+#elif defined(GAMEWINDOW_STATIC_DISPATCH_EGLUT)
+#include <native/window_eglut.h>
+#include <native/window_manager_eglut.h>
+using NativeGameWindow = EGLUTWindow;
+using NativeGameWindowManager = EGLUTWindowManager;
+#else
+#error "game_window_native.h requires a build with GAMEWINDOW_STATIC_DISPATCH"
+#endif
+
+// Only one backend is compiled in, so every manager and window is of the native type
+inline NativeGameWindowManager* getNativeManager() {
+    return static_cast<NativeGameWindowManager*>(GameWindowManager::getManager().get());
+}
+
+inline std::shared_ptr<NativeGameWindow> getNativeWindow(std::shared_ptr<GameWindow> const& window) {
+    return std::static_pointer_cast<NativeGameWindow>(window);
+}
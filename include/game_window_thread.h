@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+enum class ThreadRole {
+    // The thread calling GameWindow::pollEvents
+    EVENTS,
+    // The thread calling GameWindow::makeCurrent / swapBuffers
+    RENDER,
+    // Gamepad polling threads owned by the library
+    GAMEPAD
+};
+
+// DEFAULT keeps the inherited scheduling, or restores SCHED_OTHER if an earlier setOptions changed it
+enum class ThreadSchedulingPolicy {
+    DEFAULT, OTHER, BATCH, IDLE, FIFO, RR
+};
+
+struct ThreadOptions {
+    ThreadSchedulingPolicy policy = ThreadSchedulingPolicy::DEFAULT;
+    // Realtime priority, only used with FIFO and RR
+    int priority = 1;
+    // Nice level of the thread, also used if the realtime policy is not permitted
+    bool setNiceLevel = false;
+    int niceLevel = 0;
+    // Cpus the thread is allowed to run on, empty keeps the inherited affinity
+    std::vector<int> cpus;
+};
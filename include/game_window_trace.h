@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Trace points of the per frame paths, measured while the frame trace or the hitch watchdog is enabled.
+// See GameWindowManager::setFrameTraceEnabled and GameWindowManager::setWatchdogOptions
+class GameWindowTrace {
+
+public:
+    static std::atomic<bool> enabled;
+
+    // CLOCK_MONOTONIC in nanoseconds
+    static uint64_t now();
+
+    // name has to be a string literal, only the pointer is stored
+    static void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    class Scope {
+        const char* name;
+        uint64_t start;
+
+    public:
+        explicit Scope(const char* name) : name(name), start(enabled.load(std::memory_order_relaxed) ? now() : 0) {}
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() {
+            if (start != 0)
+                record(name, start, now());
+        }
+    };
+
+};
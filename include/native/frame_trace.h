@@ -0,0 +1,47 @@
+#pragma once
+
+#include <game_window_trace.h>
+#include <mutex>
+#include <string>
+
+class FrameTrace {
+
+public:
+    static std::atomic<bool> recording;
+
+    static void setRecording(bool recording);
+
+    // GameWindowTrace::enabled is set while the ring buffers or the watchdog need the trace points
+    static void updateEnabled();
+
+    // OS thread id shown by debuggers and profilers, the kernel tid on linux
+    static uint64_t getThreadId();
+
+    // Chrome trace event JSON of the events which ended in the last seconds, opens in ui.perfetto.dev
+    static bool write(std::string const& path, double seconds);
+
+};
+
+// x11_sync which records the time spent waiting for it
+class TracedRecursiveMutex {
+
+private:
+    std::recursive_mutex mutex;
+
+public:
+    void lock() {
+        if (mutex.try_lock())
+            return;
+        GameWindowTrace::Scope trace("x11_sync wait");
+        mutex.lock();
+    }
+
+    bool try_lock() {
+        return mutex.try_lock();
+    }
+
+    void unlock() {
+        mutex.unlock();
+    }
+
+};
@@ -4,10 +4,32 @@
 #endif
 
 #include "window_with_linux_gamepad.h"
+#include "frame_trace.h"
 
 #include <mutex>
+#include <atomic>
 
-class EGLUTWindow : public WindowWithLinuxJoystick {
+class EGLUTSharedContext final : public GameWindowContext {
+
+private:
+    // EGL types, the header doesn't include EGL/egl.h
+    void* display;
+    void* context;
+    // Pbuffer, nullptr with EGL_KHR_surfaceless_context
+    void* surface;
+    unsigned int api;
+
+public:
+    EGLUTSharedContext(void* display, void* context, void* surface, unsigned int api) :
+            display(display), context(context), surface(surface), api(api) {}
+
+    ~EGLUTSharedContext() override;
+
+    void makeCurrent(bool active) override;
+
+};
+
+class EGLUTWindow final : public WindowWithLinuxJoystick {
 
 private:
     static EGLUTWindow* currentWindow;
@@ -17,17 +39,28 @@ private:
     GraphicsApi graphicsApi;
     int winId = -1;
     bool cursorDisabled = false;
+    bool reportedFullscreen = false;
+    ContextConfig contextConfig;
+    // Context created by eglut, used to create shared contexts
+    void* eglDisplay = nullptr;
+    void* eglContext = nullptr;
+    void* eglConfig = nullptr;
+    // show() was called while waiting for the first frame, see WindowOptions::hiddenUntilFirstFrame
+    bool showPending = false;
+    std::atomic<bool> waitForFirstFrame {false};
     bool moveMouseToCenter = false;
     int lastMouseX = -1, lastMouseY = -1;
     bool modCTRL = false;
     int pointerIds[16];
 
 #ifdef GAMEWINDOW_X11_LOCK
-    std::recursive_mutex x11_sync;
+    TracedRecursiveMutex x11_sync;
 #endif
 
     static KeyCode getKeyMinecraft(int keyCode);
 
+    void queryContextConfig();
+
     static void _eglutIdleFunc();
     static void _eglutDisplayFunc();
     static void _eglutReshapeFunc(int w, int h);
@@ -47,7 +80,7 @@ private:
     void releaseTouchPointer(int ourId);
 
 public:
-    EGLUTWindow(const std::string& title, int width, int height, GraphicsApi api);
+    EGLUTWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options = {});
 
     ~EGLUTWindow() override;
 
@@ -69,6 +102,12 @@ public:
 
     void setFullscreen(bool fullscreen) override;
 
+    FullscreenType getFullscreenType() override;
+
+    ContextConfig getContextConfig() override;
+
+    std::shared_ptr<GameWindowContext> createSharedContext() override;
+
     void getWindowSize(int& width, int& height) const override;
 
     void setClipboardText(std::string const& text) override;
@@ -0,0 +1,191 @@
+#pragma once
+#if !defined(GAMEWINDOW_NO_X11_LOCK) && !defined(GAMEWINDOW_X11_LOCK) && !defined(__APPLE__)
+#define GAMEWINDOW_X11_LOCK
+#endif
+
+#include <game_window.h>
+#include "frame_trace.h"
+#include <GLFW/glfw3.h>
+#include <mutex>
+#include <atomic>
+
+class GLFWSharedContext final : public GameWindowContext {
+
+private:
+    // Hidden window, glfw has no contexts without a window
+    GLFWwindow* window;
+
+public:
+    explicit GLFWSharedContext(GLFWwindow* window) : window(window) {}
+
+    ~GLFWSharedContext() override;
+
+    void makeCurrent(bool active) override;
+
+};
+
+// Creates the glfw window and context of a GLFWGameWindow, one context configuration per step.
+// See GameWindowManager::createWindowSteps
+class GLFWWindowCreation {
+
+private:
+    // One step of the context creation fallback chain
+    struct ContextAttempt {
+        const char* name;
+        int client;
+        int major, minor;
+        int profile;
+        bool noError;
+    };
+
+    std::string title;
+    int width, height;
+    GraphicsApi api;
+    WindowOptions options;
+    // Fullscreen monitor and its desktop video mode, nullptr for a windowed window
+    GLFWmonitor* monitor = nullptr;
+    const GLFWvidmode* desktop = nullptr;
+    int createWidth, createHeight, refreshRate = GLFW_DONT_CARE;
+    std::vector<ContextAttempt> attempts, defaultAttempts;
+    size_t nextAttempt = 0;
+    std::string cacheKey, cachedName, cachedRenderer;
+    bool reprobed = false;
+    GLFWwindow* window = nullptr;
+
+    friend class GLFWGameWindow;
+
+    GLFWwindow* tryCreateWindow(ContextAttempt const& attempt);
+
+public:
+    GLFWWindowCreation(std::string title, int width, int height, GraphicsApi api, WindowOptions const& options);
+
+    GLFWWindowCreation(GLFWWindowCreation const&) = delete;
+    GLFWWindowCreation& operator=(GLFWWindowCreation const&) = delete;
+
+    ~GLFWWindowCreation();
+
+    // Tries the next context configuration, true once the window was created or every configuration failed
+    bool step();
+
+    // Takes the created window, throws if every configuration failed
+    std::shared_ptr<GameWindow> finish();
+
+};
+
+class GLFWGameWindow final : public GameWindow {
+
+private:
+    GLFWwindow* window;
+    double lastMouseX = 0.0, lastMouseY = 0.0;
+    int windowedX = -1, windowedY = -1;
+    // width and height in content pixels
+    int width = -1, height = -1;
+    // width and height in window coordinates = pixels / relativeScale
+    int windowedWidth = -1, windowedHeight = -1;
+    int relativeScale;
+    bool resized = false;
+    bool focused = true;
+    bool warnedButtons = false;
+    bool requestFullscreen = false;
+    bool pendingFullscreenModeSwitch = false;
+    FullscreenMode mode = { -1 };
+    FullscreenType fullscreenType = FullscreenType::EXCLUSIVE;
+    // Monitor our exclusive video mode is set on and its desktop mode from before the modeset
+    GLFWmonitor* modesetMonitor = nullptr;
+    GLFWvidmode desktopMode;
+    ContextConfig contextConfig;
+    // false for GraphicsApi::VULKAN
+    bool hasContext;
+    bool reportedFullscreen = false;
+    // show() was called while waiting for the first frame, see WindowOptions::hiddenUntilFirstFrame
+    bool showPending = false;
+    std::atomic<bool> waitForFirstFrame {false};
+    int fullscreenMonitor = -1;
+    // Monitor the window is on, updated lazily after the window moved or the monitors changed
+    GLFWmonitor* currentMonitor = nullptr;
+    float currentRefreshRate = 0.0f;
+    bool monitorDirty = true;
+    unsigned monitorGeneration = 0;
+
+    friend class GLFWJoystickManager;
+
+#ifdef GAMEWINDOW_X11_LOCK
+    TracedRecursiveMutex x11_sync;
+#endif
+
+    static KeyCode getKeyMinecraft(int keyCode);
+
+    static void _glfwWindowSizeCallback(GLFWwindow* window, int w, int h);
+    static void _glfwCursorPosCallback(GLFWwindow* window, double x, double y);
+    static void _glfwMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void _glfwScrollCallback(GLFWwindow* window, double x, double y);
+    static void _glfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void _glfwCharCallback(GLFWwindow* window, unsigned int ch);
+    static void _glfwWindowCloseCallback(GLFWwindow* window);
+    static void _glfwWindowFocusCallback(GLFWwindow* window, int focused);
+    static void _glfwWindowContentScaleCallback(GLFWwindow* window, float scalex, float scaley);
+    static void _glfwWindowPosCallback(GLFWwindow* window, int x, int y);
+
+    void updateMonitor();
+    GLFWmonitor* getTargetMonitor();
+    void enterFullscreen(GLFWmonitor* monitor);
+    void queryContextConfig(GraphicsApi api, ContextConfig const& requested);
+
+public:
+
+    explicit GLFWGameWindow(GLFWWindowCreation& creation);
+
+    ~GLFWGameWindow() override;
+
+    void setIcon(std::string const& iconPath) override;
+
+    void makeCurrent(bool active) override;
+
+    int getRelativeScale() const;
+
+    void setRelativeScale();
+
+    void show() override;
+
+    void close() override;
+
+    void pollEvents() override;
+
+    bool getCursorDisabled() override;
+
+    void setCursorDisabled(bool disabled) override;
+
+    bool getFullscreen() override;
+
+    void setFullscreen(bool fullscreen) override;
+
+    void getWindowSize(int& width, int& height) const override;
+
+    void setClipboardText(std::string const& text) override;
+
+    void swapBuffers() override;
+
+    void setSwapInterval(int interval) override;
+
+    void setFullscreenMode(const FullscreenMode& mode) override;
+
+    void setFullscreenType(FullscreenType type) override;
+
+    FullscreenType getFullscreenType() override;
+
+    FullscreenMode getFullscreenMode() override;
+
+    std::vector<FullscreenMode> getFullscreenModes() override;
+
+    int getMonitor() override;
+
+    void setFullscreenMonitor(int monitor) override;
+
+    float getRefreshRate() override;
+
+    ContextConfig getContextConfig() override;
+
+    std::shared_ptr<GameWindowContext> createSharedContext() override;
+
+    uint64_t createVulkanSurface(void* instance) override;
+};
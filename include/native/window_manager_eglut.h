@@ -1,15 +1,19 @@
 #pragma once
 
-#include "game_window_manager.h"
+#include <game_window_manager.h>
 
-class EGLUTWindowManager : public GameWindowManager {
+class EGLUTWindowManager final : public GameWindowManager {
 
 public:
     EGLUTWindowManager();
 
     ProcAddrFunc getProcAddrFunc() override;
 
-    std::shared_ptr<GameWindow> createWindow(const std::string& title, int width, int height, GraphicsApi api) override;
+    bool isPlatformExtensionSupported(const char* name) override;
+
+    using GameWindowManager::createWindow;
+
+    std::shared_ptr<GameWindow> createWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) override;
 
     void addGamepadMappingFile(const std::string& path) override;
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <game_window_manager.h>
+
+class SDL3WindowManager final : public GameWindowManager {
+
+public:
+    SDL3WindowManager();
+
+    ProcAddrFunc getProcAddrFunc() override;
+
+    bool isPlatformExtensionSupported(const char* name) override;
+
+    using GameWindowManager::createWindow;
+
+    std::shared_ptr<GameWindow> createWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) override;
+
+    void addGamepadMappingFile(const std::string& path) override;
+
+    void addGamePadMapping(const std::string &content) override;
+
+    std::vector<MonitorInfo> getMonitors() override;
+
+    std::vector<std::string> getVulkanInstanceExtensions() override;
+};
\ No newline at end of file
@@ -5,13 +5,31 @@
 
 #include <game_window.h>
 #include <mutex>
+#include <atomic>
 #include <SDL3/SDL.h>
 
-class SDL3GameWindow : public GameWindow {
+class SDL3SharedContext final : public GameWindowContext {
 
 private:
+    // Hidden window, a window surface can only be current on one thread
     SDL_Window* window;
     SDL_GLContext context;
+
+public:
+    SDL3SharedContext(SDL_Window* window, SDL_GLContext context) : window(window), context(context) {}
+
+    ~SDL3SharedContext() override;
+
+    void makeCurrent(bool active) override;
+
+};
+
+class SDL3GameWindow final : public GameWindow {
+
+private:
+    SDL_Window* window;
+    // nullptr for GraphicsApi::VULKAN
+    SDL_GLContext context = nullptr;
     double lastMouseX = 0.0, lastMouseY = 0.0;
     int windowedX = -1, windowedY = -1;
     // width and height in content pixels
@@ -25,13 +43,21 @@ private:
     bool requestFullscreen = false;
     bool pendingFullscreenModeSwitch = false;
     FullscreenMode mode;
-    std::vector<FullscreenMode> modes;
+    int fullscreenMonitor = -1;
+    FullscreenType fullscreenType = FullscreenType::EXCLUSIVE;
+    ContextConfig contextConfig;
+    // show() was called while waiting for the first frame, see WindowOptions::hiddenUntilFirstFrame
+    bool showPending = false;
+    std::atomic<bool> waitForFirstFrame {false};
 
     static KeyCode getKeyMinecraft(int keyCode);
 
+    SDL_DisplayID getTargetDisplay();
+    void queryContextConfig(GraphicsApi api);
+
 public:
 
-    SDL3GameWindow(const std::string& title, int width, int height, GraphicsApi api);
+    SDL3GameWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options = {});
 
     ~SDL3GameWindow() override;
 
@@ -71,8 +97,24 @@ public:
 
     void setFullscreenMode(const FullscreenMode& mode) override;
 
+    void setFullscreenType(FullscreenType type) override;
+
+    FullscreenType getFullscreenType() override;
+
     FullscreenMode getFullscreenMode() override;
 
     std::vector<FullscreenMode> getFullscreenModes() override;
 
+    int getMonitor() override;
+
+    void setFullscreenMonitor(int monitor) override;
+
+    float getRefreshRate() override;
+
+    ContextConfig getContextConfig() override;
+
+    std::shared_ptr<GameWindowContext> createSharedContext() override;
+
+    uint64_t createVulkanSurface(void* instance) override;
+
 };
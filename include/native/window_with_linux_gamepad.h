@@ -16,4 +16,6 @@ public:
 
     void updateGamepad();
 
+    void dispatchGamepadEvents();
+
 };
\ No newline at end of file
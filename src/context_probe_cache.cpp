@@ -0,0 +1,46 @@
+#include "context_probe_cache.h"
+#include "game_window_cache.h"
+
+#include <fstream>
+
+static const char* const cacheName = "context-probe";
+
+std::mutex ContextProbeCache::mutex;
+std::map<std::string, std::string> ContextProbeCache::entries;
+bool ContextProbeCache::loaded = false;
+
+void ContextProbeCache::load() {
+    loaded = true;
+    auto path = GameWindowCache::getPath(cacheName);
+    if (path.empty())
+        return;
+    std::ifstream fs(path);
+    std::string line;
+    while (std::getline(fs, line)) {
+        auto sep = line.find('\t');
+        if (sep != std::string::npos)
+            entries[line.substr(0, sep)] = line.substr(sep + 1);
+    }
+}
+
+std::string ContextProbeCache::get(std::string const& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded)
+        load();
+    auto it = entries.find(key);
+    return it != entries.end() ? it->second : std::string();
+}
+
+void ContextProbeCache::set(std::string const& key, std::string const& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded)
+        load();
+    auto& entry = entries[key];
+    if (entry == value)
+        return;
+    entry = value;
+    std::string data;
+    for (auto& e : entries)
+        data += e.first + '\t' + e.second + '\n';
+    GameWindowCache::writeFile(cacheName, data);
+}
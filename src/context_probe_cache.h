@@ -0,0 +1,28 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// Context configurations which succeeded on previous starts, lets the backends skip context creation attempts known to fail.
+// Stored as one "key\tvalue" line per entry in the game-window cache directory
+class ContextProbeCache {
+
+private:
+    static std::mutex mutex;
+    static std::map<std::string, std::string> entries;
+    static bool loaded;
+
+    static void load();
+
+public:
+    // Part of the keys, bump it when the attempt names or the value format change so old entries are ignored
+    static const int formatVersion = 1;
+
+    // Returns an empty string if nothing was recorded for the key
+    static std::string get(std::string const& key);
+
+    // Rewrites the cache file if the value changed
+    static void set(std::string const& key, std::string const& value);
+
+};
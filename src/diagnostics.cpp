@@ -0,0 +1,197 @@
+#include "diagnostics.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+Diagnostics::Slot Diagnostics::slots[Diagnostics::capacity];
+std::atomic<size_t> Diagnostics::enqueuePos {0};
+std::atomic<size_t> Diagnostics::dequeuePos {0};
+std::atomic<uint32_t> Diagnostics::dropped {0};
+std::atomic<uint64_t> Diagnostics::intervalNs[(int) DiagnosticCode::COUNT];
+std::atomic<uint64_t> Diagnostics::lastReportNs[(int) DiagnosticCode::COUNT];
+std::atomic<uint32_t> Diagnostics::suppressed[(int) DiagnosticCode::COUNT];
+
+namespace {
+    std::once_flag threadOnce;
+    std::thread thread;
+    thread_local bool isDiagnosticsThread = false;
+    std::atomic<bool> running {true};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> delivered {0};
+
+    std::mutex handlerMutex;
+    std::shared_ptr<GameWindowErrorHandler> handler;
+
+    struct DefaultRateLimits {
+        DefaultRateLimits();
+    } defaultRateLimits;
+}
+
+DefaultRateLimits::DefaultRateLimits() {
+    for (int i = 0; i < (int) DiagnosticCode::COUNT; i++)
+        Diagnostics::setRateLimit((DiagnosticCode) i, 1000.0);
+    // The watchdog and the GL debug output limit their reports themselves
+    Diagnostics::setRateLimit(DiagnosticCode::HITCH, 0.0);
+    Diagnostics::setRateLimit(DiagnosticCode::GL_DEBUG, 0.0);
+}
+
+static uint64_t getTimeNs() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Diagnostics::setRateLimit(DiagnosticCode code, double intervalMs) {
+    intervalNs[(int) code] = intervalMs > 0.0 ? (uint64_t) (intervalMs * 1e6) : 0;
+}
+
+bool Diagnostics::admit(DiagnosticCode code, uint64_t now) {
+    uint64_t interval = intervalNs[(int) code].load(std::memory_order_relaxed);
+    if (interval == 0)
+        return true;
+    uint64_t last = lastReportNs[(int) code].load(std::memory_order_relaxed);
+    if ((last != 0 && now - last < interval) || !lastReportNs[(int) code].compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        suppressed[(int) code].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool Diagnostics::admit(DiagnosticCode code) {
+    return admit(code, getTimeNs());
+}
+
+void Diagnostics::setHandler(std::shared_ptr<GameWindowErrorHandler> handler) {
+    std::lock_guard<std::mutex> lock(handlerMutex);
+    ::handler = std::move(handler);
+}
+
+void Diagnostics::push(DiagnosticCode code, DiagnosticSeverity severity, const char* source, const char* staticMessage, std::string message,
+                       std::string (*format)(const void* args), const void* args, size_t argsSize) {
+    std::call_once(threadOnce, startThread);
+    // Bounded multi producer queue, each slot carries the position it is ready for
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[pos % capacity];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->code = code;
+    slot->severity = severity;
+    slot->source = source;
+    slot->staticMessage = staticMessage;
+    slot->message = std::move(message);
+    slot->format = format;
+    if (argsSize > 0)
+        memcpy(slot->args, args, argsSize);
+    slot->timeNs = getTimeNs();
+    slot->suppressed = suppressed[(int) code].exchange(0, std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    wake.notify_one();
+}
+
+bool Diagnostics::pop(GameWindowDiagnostic& diagnostic) {
+    // Single consumer, the diagnostics thread
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    auto& slot = slots[pos % capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+        return false;
+    diagnostic.code = slot.code;
+    diagnostic.severity = slot.severity;
+    diagnostic.source = slot.source;
+    if (slot.format)
+        diagnostic.message = slot.format(slot.args);
+    else
+        diagnostic.message = slot.staticMessage ? std::string(slot.staticMessage) : std::move(slot.message);
+    slot.message.clear();
+    diagnostic.timeNs = slot.timeNs;
+    diagnostic.suppressed = slot.suppressed;
+    diagnostic.dropped = dropped.exchange(0, std::memory_order_relaxed);
+    slot.sequence.store(pos + capacity, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void Diagnostics::startThread() {
+    for (size_t i = 0; i < capacity; i++)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    thread = std::thread(threadMain);
+    // Runs before the destructors of the statics constructed earlier, like the manager instance
+    atexit(stopThread);
+}
+
+void Diagnostics::stopThread() {
+    running = false;
+    wake.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void Diagnostics::threadMain() {
+    isDiagnosticsThread = true;
+    GameWindowDiagnostic diagnostic;
+    while (true) {
+        bool wasRunning = running;
+        std::shared_ptr<GameWindowErrorHandler> target;
+        {
+            std::lock_guard<std::mutex> lock(handlerMutex);
+            target = handler;
+        }
+        while (pop(diagnostic)) {
+            if (target)
+                target->onDiagnostic(diagnostic);
+            else
+                printf("[%s]: %s\n", diagnostic.source.c_str(), diagnostic.message.c_str());
+            delivered.fetch_add(1, std::memory_order_release);
+        }
+        wake.notify_all();
+        // The remaining reports are delivered once more after the stop request
+        if (!wasRunning)
+            break;
+        // Producers never take the mutex, the timeout bounds the delay of a missed wakeup
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, std::chrono::milliseconds(100));
+    }
+}
+
+void Diagnostics::report(DiagnosticCode code, DiagnosticSeverity severity, const char* source, const char* message) {
+    if (admit(code, getTimeNs()))
+        push(code, severity, source, message, std::string());
+}
+
+void Diagnostics::report(DiagnosticCode code, DiagnosticSeverity severity, const char* source, std::string message) {
+    if (admit(code, getTimeNs()))
+        push(code, severity, source, nullptr, std::move(message));
+}
+
+void Diagnostics::reportAdmitted(DiagnosticCode code, DiagnosticSeverity severity, const char* source, std::string message) {
+    push(code, severity, source, nullptr, std::move(message));
+}
+
+void Diagnostics::flush() {
+    // The thread would wait for itself, and nothing is delivered for certain after the stop
+    if (isDiagnosticsThread || !running)
+        return;
+    size_t target = enqueuePos.load(std::memory_order_acquire);
+    if (target == 0)
+        return;
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wake.notify_all();
+    while (delivered.load(std::memory_order_acquire) < target && running)
+        wake.wait_for(lock, std::chrono::milliseconds(10));
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <game_window_error_handler.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+// Rate limited diagnostics, delivered to GameWindowErrorHandler::onDiagnostic by a background thread.
+// Reporting never blocks, reports are dropped if the queue is full
+class Diagnostics {
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        DiagnosticCode code;
+        DiagnosticSeverity severity;
+        const char* source;
+        // Literal messages are not copied
+        const char* staticMessage;
+        std::string message;
+        // Raw arguments formatted on the diagnostics thread, see reportDeferred
+        std::string (*format)(const void* args);
+        alignas(8) unsigned char args[320];
+        uint64_t timeNs;
+        uint32_t suppressed;
+    };
+
+    static const size_t capacity = 256;
+
+    static Slot slots[capacity];
+    static std::atomic<size_t> enqueuePos, dequeuePos;
+    static std::atomic<uint32_t> dropped;
+    static std::atomic<uint64_t> intervalNs[(int) DiagnosticCode::COUNT];
+    static std::atomic<uint64_t> lastReportNs[(int) DiagnosticCode::COUNT];
+    static std::atomic<uint32_t> suppressed[(int) DiagnosticCode::COUNT];
+
+    static bool admit(DiagnosticCode code, uint64_t now);
+
+    static void push(DiagnosticCode code, DiagnosticSeverity severity, const char* source, const char* staticMessage, std::string message,
+                     std::string (*format)(const void* args) = nullptr, const void* args = nullptr, size_t argsSize = 0);
+
+    static bool pop(GameWindowDiagnostic& diagnostic);
+
+    static void startThread();
+
+    static void threadMain();
+
+    static void stopThread();
+
+public:
+    // Set by the manager, the thread never calls into GameWindowManager
+    static void setHandler(std::shared_ptr<GameWindowErrorHandler> handler);
+
+    // source and message have to be string literals
+    static void report(DiagnosticCode code, DiagnosticSeverity severity, const char* source, const char* message);
+
+    static void report(DiagnosticCode code, DiagnosticSeverity severity, const char* source, std::string message);
+
+    // Reports without building the message on the calling thread. Args is copied into the queue and its
+    // std::string format() const is called on the diagnostics thread, so it must not point to temporaries
+    template <typename Args>
+    static void reportDeferred(DiagnosticCode code, DiagnosticSeverity severity, const char* source, Args const& args) {
+        static_assert(std::is_trivially_copyable<Args>::value && sizeof(Args) <= sizeof(Slot::args) && alignof(Args) <= 8,
+                      "Args has to fit a queue slot");
+        if (admit(code))
+            push(code, severity, source, nullptr, std::string(), [](const void* args) { return ((const Args*) args)->format(); }, &args, sizeof(Args));
+    }
+
+    // Takes the rate limit of code for a message that is expensive to build, report it with reportAdmitted if true
+    static bool admit(DiagnosticCode code);
+
+    static void reportAdmitted(DiagnosticCode code, DiagnosticSeverity severity, const char* source, std::string message);
+
+    // Minimum time between two delivered reports of a code, 0 delivers every report
+    static void setRateLimit(DiagnosticCode code, double intervalMs);
+
+    // Waits until the reports queued before the call were delivered. Returns immediately on the diagnostics
+    // thread itself, from GameWindowErrorHandler::onDiagnostic, and once the thread was stopped at exit
+    static void flush();
+
+};
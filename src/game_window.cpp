@@ -0,0 +1,112 @@
+#include <game_window.h>
+#include "window_stats.h"
+#include "gpu_frame_timer.h"
+#include "diagnostics.h"
+
+#include <algorithm>
+
+GameWindow::GameWindow(std::string const& title, int width, int height, GraphicsApi api) : graphicsApi(api) {
+    stats.rateStartNs = GameWindowTrace::now();
+    WindowStats::add(this);
+}
+
+GameWindow::~GameWindow() {
+    WindowStats::remove(this);
+}
+
+static void updateMax(std::atomic<uint64_t>& max, uint64_t value) {
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+void GameWindow::recordTime(TimedStat stat, uint64_t startNs, uint64_t endNs) {
+    uint64_t duration = endNs - startNs;
+    if (stat == TimedStat::SWAP_BUFFERS) {
+        StatsCounters::increment(stats.swapBuffersCalls);
+        stats.swapBuffersTotalNs.fetch_add(duration, std::memory_order_relaxed);
+        updateMax(stats.swapBuffersMaxNs, duration);
+        return;
+    }
+    StatsCounters::increment(stats.pollEventsCalls);
+    stats.pollEventsTotalNs.fetch_add(duration, std::memory_order_relaxed);
+    updateMax(stats.pollEventsMaxNs, duration);
+    // Roll the event rates once per second
+    uint64_t elapsed = endNs - stats.rateStartNs;
+    if (elapsed >= 1000000000ull) {
+        for (int i = 0; i < (int) EventCategory::COUNT; i++) {
+            uint64_t count = stats.events[i].load(std::memory_order_relaxed);
+            stats.eventsPerSecond[i].store((float) ((count - stats.rateStartEvents[i]) * 1e9 / elapsed), std::memory_order_relaxed);
+            stats.rateStartEvents[i] = count;
+        }
+        stats.rateStartNs = endNs;
+    }
+}
+
+void GameWindow::beginSwap() {
+    uint64_t now = GameWindowTrace::now();
+    if (frameStartNs != 0) {
+        uint64_t duration = now - frameStartNs;
+        StatsCounters::increment(stats.cpuFrames);
+        stats.cpuFrameTotalNs.fetch_add(duration, std::memory_order_relaxed);
+        updateMax(stats.cpuFrameMaxNs, duration);
+        if (gpuTimer)
+            gpuTimer->endFrame(duration);
+    }
+}
+
+void GameWindow::endSwap() {
+    frameStartNs = GameWindowTrace::now();
+    if (graphicsApi == GraphicsApi::VULKAN || gpuTimingUnsupported)
+        return;
+    if (!gpuTimingEnabled.load(std::memory_order_relaxed)) {
+        if (gpuTimer) {
+            gpuTimer->destroy();
+            gpuTimer.reset();
+        }
+        return;
+    }
+    if (!gpuTimer) {
+        gpuTimer.reset(new GpuFrameTimer());
+        const char* error = nullptr;
+        if (!gpuTimer->init(graphicsApi, error)) {
+            gpuTimer.reset();
+            gpuTimingUnsupported = true;
+            Diagnostics::report(DiagnosticCode::GPU_TIMING, DiagnosticSeverity::INFO, "GameWindow", std::string("GPU frame timing is unavailable: ") + error);
+            return;
+        }
+    }
+    uint64_t cpuNs, gpuNs;
+    while (gpuTimer->collect(cpuNs, gpuNs)) {
+        StatsCounters::increment(stats.gpuFrames);
+        stats.gpuFrameTotalNs.fetch_add(gpuNs, std::memory_order_relaxed);
+        updateMax(stats.gpuFrameMaxNs, gpuNs);
+        stats.gpuFramesCpuTotalNs.fetch_add(cpuNs, std::memory_order_relaxed);
+    }
+    gpuTimer->beginFrame();
+}
+
+GameWindowStats GameWindow::getStats() const {
+    GameWindowStats result;
+    for (int i = 0; i < (int) EventCategory::COUNT; i++) {
+        result.events[i] = stats.events[i].load(std::memory_order_relaxed);
+        result.eventsPerSecond[i] = stats.eventsPerSecond[i].load(std::memory_order_relaxed);
+    }
+    result.skippedCallbacks = stats.skippedCallbacks.load(std::memory_order_relaxed);
+    result.pollEventsCalls = stats.pollEventsCalls.load(std::memory_order_relaxed);
+    result.pollEventsTotalMs = stats.pollEventsTotalNs.load(std::memory_order_relaxed) / 1e6;
+    result.pollEventsMaxMs = stats.pollEventsMaxNs.load(std::memory_order_relaxed) / 1e6;
+    result.swapBuffersCalls = stats.swapBuffersCalls.load(std::memory_order_relaxed);
+    result.swapBuffersTotalMs = stats.swapBuffersTotalNs.load(std::memory_order_relaxed) / 1e6;
+    result.swapBuffersMaxMs = stats.swapBuffersMaxNs.load(std::memory_order_relaxed) / 1e6;
+    result.gamepadPolls = stats.gamepadPolls.load(std::memory_order_relaxed);
+    result.gamepadMappingMisses = stats.gamepadMappingMisses.load(std::memory_order_relaxed);
+    result.clipboardRoundTrips = stats.clipboardRoundTrips.load(std::memory_order_relaxed);
+    result.cpuFrames = stats.cpuFrames.load(std::memory_order_relaxed);
+    result.cpuFrameTotalMs = stats.cpuFrameTotalNs.load(std::memory_order_relaxed) / 1e6;
+    result.cpuFrameMaxMs = stats.cpuFrameMaxNs.load(std::memory_order_relaxed) / 1e6;
+    result.gpuFrames = stats.gpuFrames.load(std::memory_order_relaxed);
+    result.gpuFrameTotalMs = stats.gpuFrameTotalNs.load(std::memory_order_relaxed) / 1e6;
+    result.gpuFrameMaxMs = stats.gpuFrameMaxNs.load(std::memory_order_relaxed) / 1e6;
+    result.gpuFramesCpuTotalMs = stats.gpuFramesCpuTotalNs.load(std::memory_order_relaxed) / 1e6;
+    return result;
+}
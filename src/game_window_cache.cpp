@@ -0,0 +1,56 @@
+#include "game_window_cache.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool createDirectory(std::string const& path) {
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+std::string GameWindowCache::getDirectory() {
+    std::string base;
+    if (auto xdg = getenv("XDG_CACHE_HOME"))
+        base = xdg;
+    else if (auto home = getenv("HOME"))
+        base = std::string(home) + "/.cache";
+    if (base.empty() || !createDirectory(base))
+        return std::string();
+    auto dir = base + "/game-window";
+    if (!createDirectory(dir))
+        return std::string();
+    return dir;
+}
+
+std::string GameWindowCache::getPath(std::string const& name) {
+    auto dir = getDirectory();
+    if (dir.empty())
+        return std::string();
+    return dir + "/" + name;
+}
+
+bool GameWindowCache::writeFile(std::string const& name, std::string const& data) {
+    auto path = getPath(name);
+    if (path.empty())
+        return false;
+    auto tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream fs(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!fs)
+            return false;
+        fs.write(data.data(), data.size());
+        if (!fs) {
+            fs.close();
+            unlink(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// Small per user cache files, stored in $XDG_CACHE_HOME/game-window
+class GameWindowCache {
+
+public:
+    // Returns an empty string if no cache directory is available
+    static std::string getDirectory();
+
+    static std::string getPath(std::string const& name);
+
+    // Writes to a temporary file first so readers never see partial files
+    static bool writeFile(std::string const& name, std::string const& data);
+
+};
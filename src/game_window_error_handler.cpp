@@ -3,4 +3,13 @@
 bool GameWindowErrorHandler::onError(std::string title, std::string errormsg) {
     printf("[%s]: %s\n", title.c_str(), errormsg.c_str());
     return true;
-}
\ No newline at end of file
+}
+
+void GameWindowErrorHandler::onDiagnostic(GameWindowDiagnostic const& diagnostic) {
+    if (diagnostic.suppressed == 0 && diagnostic.dropped == 0) {
+        onError(diagnostic.source, diagnostic.message);
+        return;
+    }
+    onError(diagnostic.source, diagnostic.message + " (" + std::to_string(diagnostic.suppressed) + " similar suppressed, " +
+                               std::to_string(diagnostic.dropped) + " dropped)");
+}
@@ -1,9 +1,121 @@
 #include <game_window_manager.h>
+#include "thread_options.h"
+#include "main_thread_tasks.h"
+#include "startup_timings.h"
+#include "gl_dispatch_cache.h"
+#include "native/frame_trace.h"
+#include "window_stats.h"
+#include "hitch_watchdog.h"
+#include "diagnostics.h"
 
 std::shared_ptr<GameWindowManager> GameWindowManager::instance;
 
+GameWindowManager::GameWindowManager() : errorhandler(std::make_shared<GameWindowErrorHandler>()) {
+    Diagnostics::setHandler(errorhandler);
+}
+
 std::shared_ptr<GameWindowManager> GameWindowManager::getManager() {
-    if (!instance)
+    if (!instance) {
+        StartupTimings::Scope timing("createManager");
         instance = createManager();
+    }
     return instance;
-}
\ No newline at end of file
+}
+
+void GameWindowManager::setErrorHandler(std::shared_ptr<GameWindowErrorHandler> errorhandler) {
+    if (!errorhandler) {
+        Diagnostics::report(DiagnosticCode::GENERIC, DiagnosticSeverity::FAILURE, "GameWindowManager", "errorhandler have to be an object");
+        return;
+    }
+    this->errorhandler = std::move(errorhandler);
+    Diagnostics::setHandler(this->errorhandler);
+}
+
+void GameWindowManager::setDiagnosticRateLimit(DiagnosticCode code, double intervalMs) {
+    Diagnostics::setRateLimit(code, intervalMs);
+}
+
+void GameWindowManager::flushDiagnostics() {
+    Diagnostics::flush();
+}
+
+void GameWindowManager::setThreadOptions(ThreadRole role, ThreadOptions options) {
+    ThreadOptionsManager::setOptions(role, std::move(options));
+}
+
+ThreadOptions GameWindowManager::getThreadOptions(ThreadRole role) {
+    return ThreadOptionsManager::getOptions(role);
+}
+
+GameWindowManager::WindowCreationStep GameWindowManager::createWindowSteps(const std::string& title, int width, int height,
+                                                                          GraphicsApi api, WindowOptions const& options) {
+    return [this, title, width, height, api, options]() {
+        return createWindow(title, width, height, api, options);
+    };
+}
+
+using WindowPromise = std::promise<std::shared_ptr<GameWindow>>;
+
+static void postCreationStep(std::shared_ptr<GameWindowManager> manager, GameWindowManager::WindowCreationStep step,
+                             std::shared_ptr<WindowPromise> promise) {
+    MainThreadTasks::post([manager, step, promise]() {
+        std::shared_ptr<GameWindow> window;
+        try {
+            window = step();
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+            return;
+        }
+        if (window) {
+            promise->set_value(std::move(window));
+            return;
+        }
+        // Resumed by the next runMainThreadTasks, the main thread isn't blocked for the whole fallback chain
+        postCreationStep(manager, step, promise);
+    });
+}
+
+std::future<std::shared_ptr<GameWindow>> GameWindowManager::createWindowAsync(const std::string& title, int width, int height,
+                                                                               GraphicsApi api, WindowOptions const& options) {
+    // Keeps the manager alive until the creation finished
+    auto manager = shared_from_this();
+    auto promise = std::make_shared<WindowPromise>();
+    auto result = promise->get_future();
+    postCreationStep(manager, createWindowSteps(title, width, height, api, options), promise);
+    return result;
+}
+
+void GameWindowManager::runMainThreadTasks() {
+    MainThreadTasks::run();
+}
+
+std::vector<StartupTiming> GameWindowManager::getStartupTimings() {
+    return StartupTimings::get();
+}
+
+bool GameWindowManager::writeStartupTrace(std::string const& path) {
+    return StartupTimings::writeTrace(path);
+}
+void GameWindowManager::resolveProcs(GraphicsApi api, const char* const* names, AnyFunc* procs, size_t count) {
+    GLDispatchCache::resolve(*this, api, names, procs, count);
+}
+
+bool GameWindowManager::hasExtension(GraphicsApi api, const char* name) {
+    return GLDispatchCache::hasExtension(*this, api, name);
+}
+
+GameWindowStats GameWindowManager::getStats() {
+    return WindowStats::get();
+}
+
+void GameWindowManager::setFrameTraceEnabled(bool enabled) {
+    FrameTrace::setRecording(enabled);
+}
+
+void GameWindowManager::setWatchdogOptions(WatchdogOptions options) {
+    HitchWatchdog::setOptions(options);
+}
+
+bool GameWindowManager::writeFrameTrace(std::string const& path, double seconds) {
+    return FrameTrace::write(path, seconds);
+}
@@ -0,0 +1,186 @@
+#include <game_window_trace.h>
+#include "native/frame_trace.h"
+#include "hitch_watchdog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::atomic<bool> GameWindowTrace::enabled {false};
+std::atomic<bool> FrameTrace::recording {false};
+
+namespace {
+    // Enough for a few seconds of a busy event thread
+    const uint64_t bufferCapacity = 16384;
+
+    struct Event {
+        // Relaxed atomics, a dump may read an event while its thread overwrites it
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> start, end;
+    };
+
+    // Written by its thread only, read by dumps
+    struct Buffer {
+        uint64_t threadId;
+        std::atomic<uint64_t> head {0};
+        Event events[bufferCapacity];
+    };
+
+    // Buffers handed out without allocating on the first record of the usual event, render and gamepad threads
+    const size_t reservedBuffers = 4;
+
+    std::mutex buffersMutex;
+    // Buffers outlive their threads, so dumps still see the events of exited threads until
+    // a new thread takes the buffer over
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<Buffer*> freeBuffers;
+
+    thread_local Buffer* threadBuffer = nullptr;
+    // Returns the buffer to the free list when its thread exits. Unlike a thread_local with a
+    // destructor, setting the key doesn't allocate
+    pthread_key_t threadBufferKey;
+    std::once_flag threadBufferKeyOnce;
+
+    void releaseThreadBuffer(void* buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        freeBuffers.push_back((Buffer*) buffer);
+    }
+
+    Buffer* createThreadBuffer() {
+        std::call_once(threadBufferKeyOnce, [] { pthread_key_create(&threadBufferKey, releaseThreadBuffer); });
+        uint64_t threadId = FrameTrace::getThreadId();
+        Buffer* buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            if (!freeBuffers.empty()) {
+                // Dumps hold the mutex, so none is reading the buffer while it is reset
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+                buffer->head.store(0, std::memory_order_relaxed);
+                buffer->threadId = threadId;
+            }
+        }
+        if (buffer == nullptr) {
+            std::unique_ptr<Buffer> created (new Buffer());
+            buffer = created.get();
+            buffer->threadId = threadId;
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(std::move(created));
+            freeBuffers.reserve(buffers.size());
+        }
+        pthread_setspecific(threadBufferKey, buffer);
+        return buffer;
+    }
+
+    void reserveBuffers() {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        while (freeBuffers.size() < reservedBuffers) {
+            buffers.emplace_back(new Buffer());
+            freeBuffers.reserve(buffers.size());
+            freeBuffers.push_back(buffers.back().get());
+        }
+    }
+}
+
+uint64_t GameWindowTrace::now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+uint64_t FrameTrace::getThreadId() {
+#if defined(__linux__)
+    return (uint64_t) syscall(SYS_gettid);
+#elif defined(__APPLE__)
+    uint64_t id = 0;
+    pthread_threadid_np(nullptr, &id);
+    return id;
+#else
+    return (uint64_t) std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+}
+
+void FrameTrace::setRecording(bool recording) {
+    if (recording)
+        reserveBuffers();
+    FrameTrace::recording = recording;
+    updateEnabled();
+}
+
+void FrameTrace::updateEnabled() {
+    GameWindowTrace::enabled = recording || HitchWatchdog::isEnabled();
+}
+
+// Not inlined, its return address is the frame of the trace point for the hitch backtraces
+__attribute__((noinline)) void GameWindowTrace::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    HitchWatchdog::check(name, startNs, endNs, __builtin_return_address(0));
+    if (!FrameTrace::recording.load(std::memory_order_relaxed))
+        return;
+    auto buffer = threadBuffer;
+    if (buffer == nullptr)
+        buffer = threadBuffer = createThreadBuffer();
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    auto& event = buffer->events[index % bufferCapacity];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(startNs, std::memory_order_relaxed);
+    event.end.store(endNs, std::memory_order_relaxed);
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+bool FrameTrace::write(std::string const& path, double seconds) {
+    struct Copy {
+        const char* name;
+        uint64_t start, end, threadId;
+    };
+    std::vector<Copy> copies;
+    uint64_t since = GameWindowTrace::now() - (uint64_t) (seconds * 1e9);
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers) {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head > bufferCapacity ? head - bufferCapacity : 0;
+            size_t offset = copies.size();
+            for (uint64_t i = first; i < head; i++) {
+                auto& event = buffer->events[i % bufferCapacity];
+                copies.push_back({event.name.load(std::memory_order_relaxed), event.start.load(std::memory_order_relaxed),
+                                  event.end.load(std::memory_order_relaxed), buffer->threadId});
+            }
+            // Drop the events the thread may have overwritten while copying, including the slot
+            // of index newHead it may be writing right now
+            uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+            if (newHead + 1 - first > bufferCapacity) {
+                size_t overwritten = std::min<uint64_t>(newHead + 1 - first - bufferCapacity, head - first);
+                copies.erase(copies.begin() + offset, copies.begin() + offset + overwritten);
+            }
+        }
+    }
+    std::ofstream fs(path, std::ios::trunc);
+    if (!fs)
+        return false;
+    int pid = (int) getpid();
+    char buf[512];
+    fs << "{\"traceEvents\":[";
+    snprintf(buf, sizeof(buf), "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"game-window\"}}", pid);
+    fs << buf;
+    for (auto& event : copies) {
+        // A torn event of a slot being rewritten can still slip through
+        if (event.end < since || event.end < event.start || event.name == nullptr)
+            continue;
+        // The names are literals of the library, no escaping required
+        snprintf(buf, sizeof(buf), ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%llu}",
+                 event.name, event.start / 1000.0, (event.end - event.start) / 1000.0, pid, (unsigned long long) event.threadId);
+        fs << buf;
+    }
+    fs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return (bool) fs;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct GamepadEvent {
+    enum class Type {
+        STATE, BUTTON, AXIS
+    };
+
+    Type type;
+    // GameWindowTrace::now() of the sample, see GameWindow::getGamepadEventTime
+    uint64_t timeNs;
+    int index;
+    // GamepadButtonId or GamepadAxisId
+    int id;
+    // Axis value, 1.0 / 0.0 for pressed / connected
+    float value;
+};
+
+// Lock-free single producer single consumer queue, filled by the gamepad sampling thread.
+// Events never get lost: while the consumer is behind they wait in a backlog of the producer, in
+// which consecutive samples of an axis are merged into the latest one
+class GamepadEventQueue {
+
+private:
+    static const size_t capacity = 1024;
+
+    GamepadEvent events[capacity];
+    std::atomic<size_t> head {0}, tail {0};
+    // Only used by the producer
+    std::vector<GamepadEvent> backlog;
+
+    bool tryPush(GamepadEvent const& ev) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= capacity)
+            return false;
+        events[t % capacity] = ev;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+public:
+    void push(GamepadEvent const& ev) {
+        flush();
+        if (backlog.empty() && tryPush(ev))
+            return;
+        if (ev.type == GamepadEvent::Type::AXIS) {
+            // Merge with a queued sample of the same axis unless a button or state change of the gamepad came after it
+            for (auto it = backlog.rbegin(); it != backlog.rend() && !(it->index == ev.index && it->type != GamepadEvent::Type::AXIS); ++it) {
+                if (it->type == GamepadEvent::Type::AXIS && it->index == ev.index && it->id == ev.id) {
+                    *it = ev;
+                    return;
+                }
+            }
+        }
+        backlog.push_back(ev);
+    }
+
+    // Moves the backlog into the queue as far as it has room, called by the producer
+    void flush() {
+        size_t moved = 0;
+        while (moved < backlog.size() && tryPush(backlog[moved]))
+            moved++;
+        backlog.erase(backlog.begin(), backlog.begin() + moved);
+    }
+
+    bool pop(GamepadEvent& ev) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        ev = events[h % capacity];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+};
@@ -0,0 +1,209 @@
+#include "gamepad_mapping_database.h"
+#include "game_window_cache.h"
+#include "startup_timings.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char cacheMagic[8] = {'G', 'W', 'D', 'B', 'I', 'D', 'X', '1'};
+
+GamepadMappingDatabase::GamepadMappingDatabase(std::string path) : path(std::move(path)) {
+}
+
+GamepadMappingDatabase::~GamepadMappingDatabase() {
+    if (pendingOpen.valid())
+        pendingOpen.wait();
+    if (data != nullptr)
+        munmap((void*) data, size);
+}
+
+bool GamepadMappingDatabase::open() {
+    StartupTimings::Scope timing("loadGamepadMappings");
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t) st.st_size > UINT32_MAX) {
+        close(fd);
+        return false;
+    }
+    size = (size_t) st.st_size;
+#ifdef __APPLE__
+    mtimeSec = st.st_mtimespec.tv_sec;
+    mtimeNsec = st.st_mtimespec.tv_nsec;
+#else
+    mtimeSec = st.st_mtim.tv_sec;
+    mtimeNsec = st.st_mtim.tv_nsec;
+#endif
+    void* mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = (const char*) mem;
+
+    if (!loadCachedIndex()) {
+        buildIndex();
+        writeCachedIndex();
+    }
+    return true;
+}
+
+void GamepadMappingDatabase::openAsync() {
+    pendingOpen = std::async(std::launch::async, &GamepadMappingDatabase::open, this);
+}
+
+bool GamepadMappingDatabase::waitForOpen() {
+    if (!pendingOpen.valid())
+        return open();
+    return pendingOpen.get();
+}
+
+size_t GamepadMappingDatabase::getMappingCount() const {
+    size_t count = 0;
+    for (auto& guid : index)
+        count += guid.second.size();
+    return count;
+}
+
+void GamepadMappingDatabase::buildIndex() {
+    index.clear();
+    const char* end = data + size;
+    for (const char* line = data; line < end; ) {
+        const char* lineEnd = (const char*) memchr(line, '\n', end - line);
+        if (lineEnd == nullptr)
+            lineEnd = end;
+        size_t length = lineEnd - line;
+        if (length > 0 && line[length - 1] == '\r')
+            length--;
+        if (length > 0 && line[0] != '#') {
+            const char* comma = (const char*) memchr(line, ',', length);
+            if (comma != nullptr && comma != line && comma - line < 256)
+                index[std::string(line, comma)].push_back({(uint32_t) (line - data), (uint32_t) length});
+        }
+        line = lineEnd + 1;
+    }
+}
+
+std::string GamepadMappingDatabase::getCacheName() const {
+    char resolved[PATH_MAX];
+    std::string absPath = realpath(path.c_str(), resolved) ? resolved : path;
+    std::stringstream name;
+    name << "gamecontrollerdb-" << std::hex << std::hash<std::string>()(absPath) << ".idx";
+    return name.str();
+}
+
+template <typename T>
+static bool readValue(const char*& ptr, const char* end, T& value) {
+    if ((size_t) (end - ptr) < sizeof(T))
+        return false;
+    memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return true;
+}
+
+template <typename T>
+static void writeValue(std::string& out, T value) {
+    out.append((const char*) &value, sizeof(T));
+}
+
+bool GamepadMappingDatabase::loadCachedIndex() {
+    auto cachePath = GameWindowCache::getPath(getCacheName());
+    if (cachePath.empty())
+        return false;
+    std::ifstream fs(cachePath, std::ios::binary);
+    if (!fs)
+        return false;
+    std::string cache((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    const char* ptr = cache.data();
+    const char* end = ptr + cache.size();
+    if (cache.size() < sizeof(cacheMagic) || memcmp(ptr, cacheMagic, sizeof(cacheMagic)) != 0)
+        return false;
+    ptr += sizeof(cacheMagic);
+    uint64_t cachedSize;
+    int64_t cachedMtimeSec, cachedMtimeNsec;
+    uint32_t guidCount;
+    if (!readValue(ptr, end, cachedSize) || !readValue(ptr, end, cachedMtimeSec) ||
+        !readValue(ptr, end, cachedMtimeNsec) || !readValue(ptr, end, guidCount))
+        return false;
+    // Keyed by size and mtime, any modification of the database invalidates the index
+    if (cachedSize != size || cachedMtimeSec != mtimeSec || cachedMtimeNsec != mtimeNsec)
+        return false;
+    std::unordered_map<std::string, std::vector<Entry>> cachedIndex;
+    cachedIndex.reserve(guidCount);
+    for (uint32_t i = 0; i < guidCount; i++) {
+        uint16_t guidLength;
+        uint32_t entryCount;
+        if (!readValue(ptr, end, guidLength) || (size_t) (end - ptr) < guidLength)
+            return false;
+        std::string guid(ptr, guidLength);
+        ptr += guidLength;
+        if (!readValue(ptr, end, entryCount))
+            return false;
+        auto& entries = cachedIndex[guid];
+        for (uint32_t j = 0; j < entryCount; j++) {
+            Entry entry;
+            if (!readValue(ptr, end, entry.offset) || !readValue(ptr, end, entry.length) ||
+                (uint64_t) entry.offset + entry.length > size)
+                return false;
+            entries.push_back(entry);
+        }
+    }
+    index = std::move(cachedIndex);
+    return true;
+}
+
+void GamepadMappingDatabase::writeCachedIndex() {
+    std::string out(cacheMagic, sizeof(cacheMagic));
+    writeValue<uint64_t>(out, size);
+    writeValue<int64_t>(out, mtimeSec);
+    writeValue<int64_t>(out, mtimeNsec);
+    writeValue<uint32_t>(out, (uint32_t) index.size());
+    for (auto& guid : index) {
+        writeValue<uint16_t>(out, (uint16_t) guid.first.size());
+        out.append(guid.first);
+        writeValue<uint32_t>(out, (uint32_t) guid.second.size());
+        for (auto& entry : guid.second) {
+            writeValue<uint32_t>(out, entry.offset);
+            writeValue<uint32_t>(out, entry.length);
+        }
+    }
+    GameWindowCache::writeFile(getCacheName(), out);
+}
+
+void GamepadMappingDatabase::applyMappings(std::string const& guid, std::function<void(std::string const& mapping)> const& apply) {
+    if (!appliedGuids.insert(guid).second)
+        return;
+    auto it = index.find(guid);
+    if (it == index.end())
+        return;
+    for (auto& entry : it->second)
+        apply(std::string(data + entry.offset, entry.length));
+}
+
+void GamepadMappingPrecedence::addInline(std::string const& content) {
+    uint64_t current = next();
+    for (size_t i = 0; i < content.length(); ) {
+        size_t j = content.find('\n', i);
+        size_t end = j == std::string::npos ? content.length() : j;
+        size_t comma = content.find(',', i);
+        if (end > i && content[i] != '#' && comma < end)
+            inlineMappings[content.substr(i, comma - i)] = current;
+        if (j == std::string::npos)
+            break;
+        i = j + 1;
+    }
+}
+
+bool GamepadMappingPrecedence::allowsDatabase(std::string const& guid, GamepadMappingDatabase const& database) const {
+    auto it = inlineMappings.find(guid);
+    return it == inlineMappings.end() || it->second < database.getLoadOrder();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <cstdint>
+#include <future>
+
+// Memory mapped gamecontrollerdb.txt with a GUID index, mappings are only parsed for connected GUIDs
+class GamepadMappingDatabase {
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    std::string path;
+    const char* data = nullptr;
+    size_t size = 0;
+    int64_t mtimeSec = 0, mtimeNsec = 0;
+    std::unordered_map<std::string, std::vector<Entry>> index;
+    std::unordered_set<std::string> appliedGuids;
+    std::future<bool> pendingOpen;
+    uint64_t loadOrder = 0;
+
+    std::string getCacheName() const;
+    bool loadCachedIndex();
+    void buildIndex();
+    void writeCachedIndex();
+
+public:
+    explicit GamepadMappingDatabase(std::string path);
+
+    GamepadMappingDatabase(GamepadMappingDatabase const&) = delete;
+    GamepadMappingDatabase& operator=(GamepadMappingDatabase const&) = delete;
+
+    ~GamepadMappingDatabase();
+
+    // Maps the file and loads or builds the index, returns false if the file can't be read
+    bool open();
+
+    // Runs open on another thread, used to load the database while the window system initializes
+    void openAsync();
+
+    // Returns the result of openAsync, calls open if openAsync wasn't used
+    bool waitForOpen();
+
+    std::string const& getPath() const { return path; }
+
+    size_t getMappingCount() const;
+
+    // Position among the mapping sources, see GamepadMappingPrecedence
+    void setLoadOrder(uint64_t order) { loadOrder = order; }
+
+    uint64_t getLoadOrder() const { return loadOrder; }
+
+    // Calls apply for every mapping line of the guid, only the first time a guid is requested
+    void applyMappings(std::string const& guid, std::function<void(std::string const& mapping)> const& apply);
+
+};
+
+// Database lines are applied when a gamepad connects, long after inline mappings were added. Keeps the load order,
+// a mapping added after a database was loaded isn't replaced by the database lines of the same GUID
+class GamepadMappingPrecedence {
+
+private:
+    uint64_t order = 0;
+    std::unordered_map<std::string, uint64_t> inlineMappings;
+
+public:
+    uint64_t next() { return ++order; }
+
+    // Records the GUIDs of the mapping lines in content
+    void addInline(std::string const& content);
+
+    bool allowsDatabase(std::string const& guid, GamepadMappingDatabase const& database) const;
+
+};
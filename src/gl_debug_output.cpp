@@ -0,0 +1,140 @@
+#include "gl_debug_output.h"
+#include "diagnostics.h"
+#include <game_window_manager.h>
+
+std::mutex GLDebugOutput::mutex;
+std::unordered_map<uint64_t, GLDebugOutput::Repeats> GLDebugOutput::messages;
+std::atomic<uint32_t> GLDebugOutput::pendingRepeats {0};
+std::atomic<uint64_t> GLDebugOutput::lastFlushNs {0};
+
+namespace {
+    enum : unsigned int {
+        GL_DONT_CARE = 0x1100, GL_DEBUG_OUTPUT = 0x92E0,
+        GL_DEBUG_SOURCE_API = 0x8246, GL_DEBUG_SOURCE_WINDOW_SYSTEM = 0x8247, GL_DEBUG_SOURCE_SHADER_COMPILER = 0x8248,
+        GL_DEBUG_SOURCE_THIRD_PARTY = 0x8249, GL_DEBUG_SOURCE_APPLICATION = 0x824A,
+        GL_DEBUG_TYPE_ERROR = 0x824C, GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR = 0x824D, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR = 0x824E,
+        GL_DEBUG_TYPE_PORTABILITY = 0x824F, GL_DEBUG_TYPE_PERFORMANCE = 0x8250, GL_DEBUG_TYPE_MARKER = 0x8268,
+        GL_DEBUG_TYPE_PUSH_GROUP = 0x8269, GL_DEBUG_TYPE_POP_GROUP = 0x826A,
+        GL_DEBUG_SEVERITY_NOTIFICATION = 0x826B
+    };
+    using DebugProc = void (GAMEWINDOW_GL_APIENTRY *)(unsigned int, unsigned int, unsigned int, unsigned int, int, const char*, const void*);
+    using DebugMessageCallback = void (GAMEWINDOW_GL_APIENTRY *)(DebugProc, const void*);
+    using DebugMessageControl = void (GAMEWINDOW_GL_APIENTRY *)(unsigned int, unsigned int, unsigned int, int, const unsigned int*, unsigned char);
+    using Enable = void (GAMEWINDOW_GL_APIENTRY *)(unsigned int);
+
+    const char* getSourceName(unsigned int source) {
+        switch (source) {
+            case GL_DEBUG_SOURCE_API: return "GL API";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "GL Window System";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "GL Shader Compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY: return "GL Third Party";
+            case GL_DEBUG_SOURCE_APPLICATION: return "GL Application";
+            default: return "GL";
+        }
+    }
+
+    const char* getTypeName(unsigned int type) {
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR: return "error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+            case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+            case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+            default: return "other";
+        }
+    }
+}
+
+void GLDebugOutput::callback(unsigned int source, unsigned int type, unsigned int id, unsigned int severity,
+        int length, const char* message, const void* user) {
+    // Debug groups and markers are inserted by the application itself
+    if (type == GL_DEBUG_TYPE_MARKER || type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP)
+        return;
+    uint64_t key = ((uint64_t) (source & 0xffff) << 48) | ((uint64_t) (type & 0xffff) << 32) | id;
+    uint64_t now = GameWindowTrace::now();
+    uint32_t repeats;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = messages[key];
+        entry.severity = severity;
+        if (entry.lastReportNs != 0 && now - entry.lastReportNs < repeatIntervalNs) {
+            entry.count++;
+            pendingRepeats.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        repeats = entry.count;
+        pendingRepeats.fetch_sub(repeats, std::memory_order_relaxed);
+        entry.lastReportNs = now;
+        entry.count = 0;
+    }
+    report(key, severity, repeats, length, message);
+}
+
+void GLDebugOutput::report(uint64_t key, unsigned int severity, uint32_t repeats, int length, const char* message) {
+    unsigned int source = (unsigned int) (key >> 48), type = (unsigned int) ((key >> 32) & 0xffff), id = (unsigned int) key;
+    DiagnosticSeverity diagnosticSeverity = DiagnosticSeverity::INFO;
+    if (type == GL_DEBUG_TYPE_ERROR)
+        diagnosticSeverity = DiagnosticSeverity::FAILURE;
+    else if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        diagnosticSeverity = DiagnosticSeverity::VERBOSE;
+    else if (type >= GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR && type <= GL_DEBUG_TYPE_PERFORMANCE)
+        diagnosticSeverity = DiagnosticSeverity::WARNING;
+    std::string text = getTypeName(type);
+    text += ' ';
+    text += std::to_string(id);
+    if (message != nullptr) {
+        text += ": ";
+        if (length >= 0)
+            text.append(message, (size_t) length);
+        else
+            text += message;
+        if (repeats > 0)
+            text += " (repeated " + std::to_string(repeats) + " times)";
+    } else {
+        // The message text isn't kept, only the summary of the repeats
+        text += ": repeated " + std::to_string(repeats) + " times";
+    }
+    Diagnostics::report(DiagnosticCode::GL_DEBUG, diagnosticSeverity, getSourceName(source), std::move(text));
+}
+
+void GLDebugOutput::flushRepeats() {
+    if (pendingRepeats.load(std::memory_order_relaxed) == 0)
+        return;
+    uint64_t now = GameWindowTrace::now();
+    uint64_t last = lastFlushNs.load(std::memory_order_relaxed);
+    if (now - last < repeatIntervalNs || !lastFlushNs.compare_exchange_strong(last, now, std::memory_order_relaxed))
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& message : messages) {
+        auto& entry = message.second;
+        if (entry.count == 0 || now - entry.lastReportNs < repeatIntervalNs)
+            continue;
+        pendingRepeats.fetch_sub(entry.count, std::memory_order_relaxed);
+        report(message.first, entry.severity, entry.count, 0, nullptr);
+        entry.lastReportNs = now;
+        entry.count = 0;
+    }
+}
+
+bool GLDebugOutput::install(GraphicsApi api) {
+    auto manager = GameWindowManager::getManager();
+    bool khr = manager->hasExtension(api, "GL_KHR_debug");
+    if (!khr && (api != GraphicsApi::OPENGL || !manager->hasExtension(api, "GL_ARB_debug_output")))
+        return false;
+    const char* suffix = !khr ? "ARB" : api == GraphicsApi::OPENGL ? "" : "KHR";
+    std::string callbackName = std::string("glDebugMessageCallback") + suffix;
+    std::string controlName = std::string("glDebugMessageControl") + suffix;
+    const char* names[] = {callbackName.c_str(), controlName.c_str(), "glEnable"};
+    GameWindowManager::AnyFunc procs[3];
+    manager->resolveProcs(api, names, procs, 3);
+    if (procs[0] == nullptr || procs[1] == nullptr || procs[2] == nullptr)
+        return false;
+    // Notifications are informational chatter of some drivers, ARB_debug_output has no such severity
+    if (khr)
+        ((DebugMessageControl) procs[1])(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, 0);
+    // Asynchronous output, the driver doesn't have to serialize its work for the callback
+    ((DebugMessageCallback) procs[0])(callback, nullptr);
+    if (khr)
+        ((Enable) procs[2])(GL_DEBUG_OUTPUT);
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <game_window.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define GAMEWINDOW_GL_APIENTRY __stdcall
+#else
+#define GAMEWINDOW_GL_APIENTRY
+#endif
+
+// Forwards the KHR_debug messages of the driver as DiagnosticCode::GL_DEBUG, see ContextConfig::debugOutput.
+// Every message id is reported the first time and then at most once per second with the number of repeats,
+// repeats without a later message are summarized by flushRepeats
+class GLDebugOutput {
+
+private:
+    struct Repeats {
+        uint64_t lastReportNs = 0;
+        uint32_t count = 0;
+        unsigned int severity = 0;
+    };
+
+    static const uint64_t repeatIntervalNs = 1000000000ull;
+
+    // The driver may call back from its own threads
+    static std::mutex mutex;
+    static std::unordered_map<uint64_t, Repeats> messages;
+    // Repeats not reported yet and the time of the last flushRepeats scan, let swapBuffers skip the lock
+    static std::atomic<uint32_t> pendingRepeats;
+    static std::atomic<uint64_t> lastFlushNs;
+
+    static void report(uint64_t key, unsigned int severity, uint32_t repeats, int length, const char* message);
+
+    static void GAMEWINDOW_GL_APIENTRY callback(unsigned int source, unsigned int type, unsigned int id, unsigned int severity,
+            int length, const char* message, const void* user);
+
+public:
+    // Installs the message callback on the current context, false if it supports neither KHR_debug nor ARB_debug_output
+    static bool install(GraphicsApi api);
+
+    // Reports the repeat counts whose interval elapsed, called by swapBuffers of the windows with debug output
+    static void flushRepeats();
+
+};
@@ -0,0 +1,107 @@
+#include "gl_dispatch_cache.h"
+
+std::mutex GLDispatchCache::mutex;
+GLDispatchCache::ApiCache GLDispatchCache::caches[3];
+
+namespace {
+    enum : unsigned int {
+        GL_VERSION = 0x1F02, GL_EXTENSIONS = 0x1F03, GL_NUM_EXTENSIONS = 0x821D
+    };
+    using GetString = const unsigned char* (*)(unsigned int);
+    using GetStringi = const unsigned char* (*)(unsigned int, unsigned int);
+    using GetIntegerv = void (*)(unsigned int, int*);
+}
+
+bool GLDispatchCache::isContextCurrent(GameWindowManager::ProcAddrFunc getProcAddr) {
+    // glGetString returns null without a current context, some loaders even return null for the function itself
+    auto getString = (GetString) getProcAddr("glGetString");
+    return getString != nullptr && getString(GL_VERSION) != nullptr;
+}
+
+uint64_t GLDispatchCache::hash(const char* name) {
+    // FNV-1a, avoids constructing a std::string per lookup
+    uint64_t h = 14695981039346656037ull;
+    for (; *name; name++)
+        h = (h ^ (unsigned char) *name) * 1099511628211ull;
+    return h;
+}
+
+void GLDispatchCache::resolve(GameWindowManager& manager, GraphicsApi api, const char* const* names, GameWindowManager::AnyFunc* procs, size_t count) {
+    auto getProcAddr = manager.getProcAddrFunc();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& cache = caches[(int) api];
+    cache.procs.reserve(cache.procs.size() + count);
+    int contextCurrent = -1;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t h = hash(names[i]);
+        auto it = cache.procs.find(h);
+        if (it != cache.procs.end()) {
+            // Resolve hash collisions without caching
+            procs[i] = it->second.name == names[i] ? it->second.proc : getProcAddr(names[i]);
+            continue;
+        }
+        procs[i] = getProcAddr(names[i]);
+        // wglGetProcAddress fails without a current context, don't let such a miss stick for later windows
+        if (procs[i] == nullptr) {
+            if (contextCurrent == -1)
+                contextCurrent = isContextCurrent(getProcAddr) ? 1 : 0;
+            if (contextCurrent == 0)
+                continue;
+        }
+        cache.procs[h] = Entry {names[i], procs[i], false};
+    }
+}
+
+bool GLDispatchCache::loadExtensions(ApiCache& cache, GraphicsApi api, GameWindowManager::ProcAddrFunc getProcAddr) {
+    auto add = [&](const char* begin, size_t length) {
+        std::string name(begin, length);
+        auto& entry = cache.extensions[hash(name.c_str())];
+        if (entry.name.empty()) {
+            entry.name = std::move(name);
+            entry.supported = true;
+        }
+    };
+    // Core profiles removed GL_EXTENSIONS from glGetString
+    if (!isContextCurrent(getProcAddr))
+        return false;
+    auto getStringi = (GetStringi) getProcAddr("glGetStringi");
+    auto getIntegerv = (GetIntegerv) getProcAddr("glGetIntegerv");
+    if (api == GraphicsApi::OPENGL && getStringi && getIntegerv) {
+        int count = 0;
+        getIntegerv(GL_NUM_EXTENSIONS, &count);
+        cache.extensions.reserve(count);
+        for (int i = 0; i < count; i++) {
+            auto name = (const char*) getStringi(GL_EXTENSIONS, (unsigned int) i);
+            if (name)
+                add(name, strlen(name));
+        }
+    } else if (auto getString = (GetString) getProcAddr("glGetString")) {
+        forEachExtension((const char*) getString(GL_EXTENSIONS), add);
+    }
+    return true;
+}
+
+bool GLDispatchCache::containsExtension(const char* extensions, const char* name) {
+    size_t nameLength = strlen(name);
+    bool found = false;
+    forEachExtension(extensions, [&](const char* begin, size_t length) {
+        found = found || (length == nameLength && memcmp(begin, name, length) == 0);
+    });
+    return found;
+}
+
+bool GLDispatchCache::hasExtension(GameWindowManager& manager, GraphicsApi api, const char* name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& cache = caches[(int) api];
+    if (!cache.extensionsLoaded)
+        cache.extensionsLoaded = loadExtensions(cache, api, manager.getProcAddrFunc());
+    auto it = cache.extensions.find(hash(name));
+    if (it != cache.extensions.end() && it->second.name == name)
+        return it->second.supported;
+    // Window system extensions aren't listed by the context, remember the answer of the backend
+    bool supported = manager.isPlatformExtensionSupported(name);
+    // Only once the context list is in, it would be shadowed by the answer otherwise
+    if (it == cache.extensions.end() && cache.extensionsLoaded)
+        cache.extensions[hash(name)] = Entry {name, nullptr, supported};
+    return supported;
+}
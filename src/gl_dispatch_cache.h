@@ -0,0 +1,55 @@
+#pragma once
+
+#include <game_window_manager.h>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Entry points and extensions of the GL contexts, shared by all windows of a graphics api.
+// See GameWindowManager::resolveProcs and GameWindowManager::hasExtension
+class GLDispatchCache {
+
+private:
+    struct Entry {
+        std::string name;
+        GameWindowManager::AnyFunc proc = nullptr;
+        bool supported = false;
+    };
+    struct ApiCache {
+        std::unordered_map<uint64_t, Entry> procs;
+        std::unordered_map<uint64_t, Entry> extensions;
+        bool extensionsLoaded = false;
+    };
+
+    static std::mutex mutex;
+    static ApiCache caches[3];
+
+    static uint64_t hash(const char* name);
+
+    static bool isContextCurrent(GameWindowManager::ProcAddrFunc getProcAddr);
+
+    // Calls f(begin, length) for every name of a space separated extension list
+    template <typename F>
+    static void forEachExtension(const char* extensions, F f) {
+        while (extensions && *extensions) {
+            auto end = strchr(extensions, ' ');
+            size_t length = end ? (size_t) (end - extensions) : strlen(extensions);
+            if (length > 0)
+                f(extensions, length);
+            extensions = end ? end + 1 : nullptr;
+        }
+    }
+
+    // False if no context was current, nothing is cached then
+    static bool loadExtensions(ApiCache& cache, GraphicsApi api, GameWindowManager::ProcAddrFunc getProcAddr);
+
+public:
+    static void resolve(GameWindowManager& manager, GraphicsApi api, const char* const* names, GameWindowManager::AnyFunc* procs, size_t count);
+
+    static bool hasExtension(GameWindowManager& manager, GraphicsApi api, const char* name);
+
+    // True if a space separated list like EGL_EXTENSIONS contains name, for GameWindowManager::isPlatformExtensionSupported
+    static bool containsExtension(const char* extensions, const char* name);
+
+};
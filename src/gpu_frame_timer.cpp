@@ -0,0 +1,132 @@
+#include "gpu_frame_timer.h"
+#include <game_window_manager.h>
+#include <cstdio>
+
+namespace {
+    enum : unsigned int {
+        GL_TIMESTAMP = 0x8E28, GL_QUERY_COUNTER_BITS = 0x8864, GL_QUERY_RESULT = 0x8866,
+        GL_QUERY_RESULT_AVAILABLE = 0x8867, GL_GPU_DISJOINT_EXT = 0x8FBB,
+        GL_VERSION = 0x1F02
+    };
+    using GetString = const unsigned char* (*)(unsigned int);
+}
+
+bool GpuFrameTimer::init(GraphicsApi api, const char*& error) {
+    auto manager = GameWindowManager::getManager();
+    bool desktop = api == GraphicsApi::OPENGL;
+    if (desktop && !manager->hasExtension(api, "GL_ARB_timer_query")) {
+        // Core since OpenGL 3.3, GL_MAJOR_VERSION would raise an error on older contexts
+        int major = 0, minor = 0;
+        const char* name = "glGetString";
+        GameWindowManager::AnyFunc getString;
+        manager->resolveProcs(api, &name, &getString, 1);
+        auto version = getString ? (const char*) ((GetString) getString)(GL_VERSION) : nullptr;
+        if (version == nullptr || sscanf(version, "%d.%d", &major, &minor) != 2 || major * 10 + minor < 33) {
+            error = "GL_ARB_timer_query is not supported";
+            return false;
+        }
+    } else if (!desktop && !manager->hasExtension(api, "GL_EXT_disjoint_timer_query")) {
+        error = "GL_EXT_disjoint_timer_query is not supported";
+        return false;
+    }
+    static const char* const desktopNames[] = {
+        "glGenQueries", "glDeleteQueries", "glQueryCounter", "glGetQueryiv", "glGetQueryObjectiv", "glGetQueryObjectui64v", "glGetIntegerv"
+    };
+    static const char* const esNames[] = {
+        "glGenQueriesEXT", "glDeleteQueriesEXT", "glQueryCounterEXT", "glGetQueryivEXT", "glGetQueryObjectivEXT", "glGetQueryObjectui64vEXT", "glGetIntegerv"
+    };
+    GameWindowManager::AnyFunc procs[7];
+    manager->resolveProcs(api, desktop ? desktopNames : esNames, procs, 7);
+    for (auto proc : procs) {
+        if (proc == nullptr) {
+            error = "the timer query entry points are missing";
+            return false;
+        }
+    }
+    genQueries = (GenQueries) procs[0];
+    deleteQueries = (DeleteQueries) procs[1];
+    queryCounter = (QueryCounter) procs[2];
+    getQueryObjectiv = (GetQueryObjectiv) procs[4];
+    getQueryObjectui64v = (GetQueryObjectui64v) procs[5];
+    getIntegerv = (GetIntegerv) procs[6];
+    // Implementations of the ES extension may only support GL_TIME_ELAPSED
+    int bits = 0;
+    ((GetQueryiv) procs[3])(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    if (bits == 0) {
+        error = "timestamp queries are not supported";
+        return false;
+    }
+    checkDisjoint = !desktop;
+    if (checkDisjoint) {
+        // Reset the sticky flag
+        int disjoint = 0;
+        getIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    }
+    for (auto& slot : slots) {
+        unsigned int queries[2];
+        genQueries(2, queries);
+        slot.startQuery = queries[0];
+        slot.endQuery = queries[1];
+    }
+    return true;
+}
+
+void GpuFrameTimer::destroy() {
+    if (deleteQueries == nullptr)
+        return;
+    for (auto& slot : slots) {
+        unsigned int queries[2] = {slot.startQuery, slot.endQuery};
+        deleteQueries(2, queries);
+        slot = Slot();
+    }
+    head = tail = 0;
+    recording = false;
+}
+
+bool GpuFrameTimer::resultAvailable(unsigned int query) {
+    int available = 0;
+    getQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+void GpuFrameTimer::beginFrame() {
+    // All slots in flight, skip this frame rather than stall on the oldest result
+    if (slots[head].pending)
+        return;
+    queryCounter(slots[head].startQuery, GL_TIMESTAMP);
+    recording = true;
+}
+
+void GpuFrameTimer::endFrame(uint64_t cpuNs) {
+    if (!recording)
+        return;
+    auto& slot = slots[head];
+    queryCounter(slot.endQuery, GL_TIMESTAMP);
+    slot.cpuNs = cpuNs;
+    slot.pending = true;
+    head = (head + 1) % SLOTS;
+    recording = false;
+}
+
+bool GpuFrameTimer::collect(uint64_t& cpuNs, uint64_t& gpuNs) {
+    while (slots[tail].pending) {
+        auto& slot = slots[tail];
+        // The end timestamp completes after the start one
+        if (!resultAvailable(slot.endQuery) || !resultAvailable(slot.startQuery))
+            return false;
+        uint64_t start = 0, end = 0;
+        getQueryObjectui64v(slot.startQuery, GL_QUERY_RESULT, &start);
+        getQueryObjectui64v(slot.endQuery, GL_QUERY_RESULT, &end);
+        slot.pending = false;
+        tail = (tail + 1) % SLOTS;
+        int disjoint = 0;
+        if (checkDisjoint)
+            getIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint || end < start)
+            continue;
+        cpuNs = slot.cpuNs;
+        gpuNs = end - start;
+        return true;
+    }
+    return false;
+}
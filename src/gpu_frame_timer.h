@@ -0,0 +1,60 @@
+#pragma once
+
+#include <game_window.h>
+
+// GL timestamp queries around the frames of a window, see GameWindow::setGpuTimingEnabled.
+// All methods have to be called with the window context current. Results are read back once
+// available, a frame whose slot is still in flight is not timed instead of waiting for the gpu
+class GpuFrameTimer {
+
+private:
+    using GenQueries = void (*)(int, unsigned int*);
+    using DeleteQueries = void (*)(int, const unsigned int*);
+    using QueryCounter = void (*)(unsigned int, unsigned int);
+    using GetQueryiv = void (*)(unsigned int, unsigned int, int*);
+    using GetQueryObjectiv = void (*)(unsigned int, unsigned int, int*);
+    using GetQueryObjectui64v = void (*)(unsigned int, unsigned int, uint64_t*);
+    using GetIntegerv = void (*)(unsigned int, int*);
+
+    static constexpr int SLOTS = 4;
+
+    struct Slot {
+        unsigned int startQuery = 0, endQuery = 0;
+        uint64_t cpuNs = 0;
+        bool pending = false;
+    };
+
+    GenQueries genQueries = nullptr;
+    DeleteQueries deleteQueries = nullptr;
+    QueryCounter queryCounter = nullptr;
+    GetQueryObjectiv getQueryObjectiv = nullptr;
+    GetQueryObjectui64v getQueryObjectui64v = nullptr;
+    GetIntegerv getIntegerv = nullptr;
+    // EXT_disjoint_timer_query, results spanning a disjoint event are discarded
+    bool checkDisjoint = false;
+
+    Slot slots[SLOTS];
+    // Next slot to record into and oldest slot waiting for its result
+    int head = 0, tail = 0;
+    bool recording = false;
+
+    bool resultAvailable(unsigned int query);
+
+public:
+    // Resolves the query entry points of the current context, false if it has no timestamp queries.
+    // error is set to the reason on failure
+    bool init(GraphicsApi api, const char*& error);
+
+    // Deletes the queries, the context has to be current
+    void destroy();
+
+    // Issued after swapBuffers returned
+    void beginFrame();
+
+    // Issued just before swapBuffers, cpuNs is the time the application spent on the frame
+    void endFrame(uint64_t cpuNs);
+
+    // Pops the oldest finished frame without waiting, false if none is ready
+    bool collect(uint64_t& cpuNs, uint64_t& gpuNs);
+
+};
@@ -0,0 +1,71 @@
+#include "hitch_watchdog.h"
+#include "native/frame_trace.h"
+#include "diagnostics.h"
+
+#include <execinfo.h>
+#include <cstdlib>
+#include <sstream>
+
+std::atomic<uint64_t> HitchWatchdog::thresholdNs {0};
+std::atomic<uint64_t> HitchWatchdog::minReportIntervalNs {1000000000ull};
+std::atomic<bool> HitchWatchdog::captureBacktrace {false};
+std::atomic<uint64_t> HitchWatchdog::lastReportNs {0};
+std::atomic<uint64_t> HitchWatchdog::suppressed {0};
+
+void HitchWatchdog::setOptions(WatchdogOptions const& options) {
+    minReportIntervalNs = (uint64_t) (options.minReportIntervalMs * 1e6);
+    captureBacktrace = options.captureBacktrace;
+    thresholdNs = options.thresholdMs > 0.0 ? (uint64_t) (options.thresholdMs * 1e6) : 0;
+    FrameTrace::updateEnabled();
+}
+
+namespace {
+    // Formatted on the diagnostics thread, name is a literal of the library
+    struct HitchReport {
+        const char* name;
+        uint64_t durationNs;
+        uint64_t skipped;
+        void* caller;
+        void* frames[32];
+        int frameCount;
+
+        std::string format() const {
+            std::stringstream msg;
+            msg << name << " took " << (durationNs / 1e6) << "ms";
+            if (skipped > 0)
+                msg << ", " << skipped << " hitches since the last report";
+            char** symbols = frameCount > 0 ? backtrace_symbols(frames, frameCount) : nullptr;
+            if (symbols) {
+                // Skip the frames of the watchdog and the trace, up to the one which recorded the trace point
+                int first = 0;
+                while (first < frameCount && frames[first] != caller)
+                    first++;
+                if (first == frameCount)
+                    first = 0;
+                for (int i = first; i < frameCount; i++)
+                    msg << "\n  " << symbols[i];
+                free(symbols);
+            }
+            return msg.str();
+        }
+    };
+}
+
+void HitchWatchdog::report(const char* name, uint64_t durationNs, void* caller) {
+    // Claim the report slot, hitches of other threads meanwhile are only counted
+    uint64_t now = GameWindowTrace::now();
+    uint64_t last = lastReportNs.load(std::memory_order_relaxed);
+    if ((last != 0 && now - last < minReportIntervalNs.load(std::memory_order_relaxed)) ||
+        !lastReportNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    HitchReport hitch;
+    hitch.name = name;
+    hitch.durationNs = durationNs;
+    hitch.caller = caller;
+    hitch.skipped = suppressed.exchange(0, std::memory_order_relaxed);
+    // Only the addresses are taken here, resolving the symbols allocates
+    hitch.frameCount = captureBacktrace.load(std::memory_order_relaxed) ? backtrace(hitch.frames, 32) : 0;
+    Diagnostics::reportDeferred(DiagnosticCode::HITCH, DiagnosticSeverity::WARNING, "Watchdog", hitch);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <game_window_manager.h>
+#include <atomic>
+#include <cstdint>
+
+// Checks the durations of the trace points against WatchdogOptions::thresholdMs
+class HitchWatchdog {
+
+private:
+    static std::atomic<uint64_t> thresholdNs;
+    static std::atomic<uint64_t> minReportIntervalNs;
+    static std::atomic<bool> captureBacktrace;
+    static std::atomic<uint64_t> lastReportNs;
+    static std::atomic<uint64_t> suppressed;
+
+    static void report(const char* name, uint64_t durationNs, void* caller);
+
+public:
+    static void setOptions(WatchdogOptions const& options);
+
+    static bool isEnabled() {
+        return thresholdNs.load(std::memory_order_relaxed) != 0;
+    }
+
+    // caller is the return address of GameWindowTrace::record, the backtrace starts at its frame
+    static void check(const char* name, uint64_t startNs, uint64_t endNs, void* caller) {
+        uint64_t threshold = thresholdNs.load(std::memory_order_relaxed);
+        if (threshold != 0 && endNs - startNs > threshold)
+            report(name, endNs - startNs, caller);
+    }
+
+};
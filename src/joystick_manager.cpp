@@ -1,11 +1,10 @@
 #include "joystick_manager.h"
 #include <game_window_manager.h>
+#include "diagnostics.h"
 #include <sstream>
 
 bool JoystickManager::handleMissingGamePadMapping(std::string name, std::string guid, int axescount, int buttonscount, int hatscount, std::function<bool(std::string mapping)> updateMapping) {
 #ifndef NDEBUG
-        std::stringstream errormsg;
-        errormsg << "Missing Gamepad Mapping for controller '" << name << "'(" << guid << "). Please create a Gamepad Mapping for your gamepad.";
         std::ostringstream mapping;
         mapping << guid << "," << name;
         const char* btns[] = { "a", "b", "x", "y", "leftshoulder", "rightshoulder", "righttrigger", "lefttrigger", "back", "start", "leftstick", "rightstick", "guide", "dpleft", "dpdown", "dpright", "dpup" };
@@ -39,14 +38,18 @@ bool JoystickManager::handleMissingGamePadMapping(std::string name, std::string
         mapstr = mapstr + ",platform:Linux,\n" + mapstr + ",platform:Mac OS X,";
         bool _hasmapping = updateMapping(mapstr);
 
-        if (!_hasmapping) {
-            errormsg << " Failed to create a valid dummy mapping for this controller, you won't be able to use this controller.";
-        } else {
-            errormsg << " This Launcher has created an dummy Gamepad Mapping for you, you will have to create your own for best experience: '" << mapstr << "'";
+        // Rate limited reports skip building the message
+        if (Diagnostics::admit(DiagnosticCode::MISSING_GAMEPAD_MAPPING)) {
+            std::stringstream errormsg;
+            errormsg << "Missing Gamepad Mapping for controller '" << name << "'(" << guid << "). Please create a Gamepad Mapping for your gamepad.";
+            if (!_hasmapping) {
+                errormsg << " Failed to create a valid dummy mapping for this controller, you won't be able to use this controller.";
+            } else {
+                errormsg << " This Launcher has created an dummy Gamepad Mapping for you, you will have to create your own for best experience: '" << mapstr << "'";
+            }
+            Diagnostics::reportAdmitted(DiagnosticCode::MISSING_GAMEPAD_MAPPING, DiagnosticSeverity::WARNING, "JoystickManager", errormsg.str());
         }
 
-        GameWindowManager::getManager()->getErrorHandler()->onError("JoystickManager", errormsg.str());
-
         return _hasmapping;
 #else
         return false;
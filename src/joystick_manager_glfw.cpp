@@ -1,33 +1,92 @@
 #include "joystick_manager_glfw.h"
 
 #include <cstring>
-#include <fstream>
-#include "window_glfw.h"
+#include "native/window_glfw.h"
 #include "joystick_manager.h"
 #include "game_window_manager.h"
 
+bool GLFWJoystickManager::active;
+std::vector<GLFWJoystickManager::PendingMapping> GLFWJoystickManager::pendingMappings;
+std::vector<std::unique_ptr<GamepadMappingDatabase>> GLFWJoystickManager::mappingDatabases;
+GamepadMappingPrecedence GLFWJoystickManager::mappingPrecedence;
 std::unordered_set<GLFWGameWindow*> GLFWJoystickManager::windows;
 GLFWGameWindow* GLFWJoystickManager::focusedWindow;
 std::unordered_map<int, GLFWJoystickManager::JoystickInfo> GLFWJoystickManager::connectedJoysticks;
 std::unordered_set<int> GLFWJoystickManager::userIds;
 
 void GLFWJoystickManager::init() {
+    // Mappings and joysticks are only touched once a window registers a gamepad callback, see activate
+    pendingMappings.push_back({true, "gamecontrollerdb.txt", nullptr});
+}
+
+void GLFWJoystickManager::activate() {
+    if (active)
+        return;
+    active = true;
     glfwSetJoystickCallback(_glfwJoystickCallback);
-    loadMappingsFromFile("gamecontrollerdb.txt");
+    auto mappings = std::move(pendingMappings);
+    pendingMappings.clear();
+    for (auto& mapping : mappings) {
+        if (mapping.isFile && mapping.database)
+            addDatabase(std::move(mapping.database));
+        else if (mapping.isFile)
+            loadMappingsFromFile(mapping.value);
+        else
+            loadMappings(mapping.value);
+    }
+    if (!windows.empty())
+        scanJoysticks();
+}
+
+void GLFWJoystickManager::scanJoysticks() {
+    for (int i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; i++) {
+        if (glfwJoystickPresent(i)) {
+            _glfwJoystickCallback(i, GLFW_CONNECTED);
+        }
+    }
 }
 
 void GLFWJoystickManager::loadMappingsFromFile(std::string const& path) {
-    std::ifstream fs(path);
-    if (!fs)
+    std::unique_ptr<GamepadMappingDatabase> database(new GamepadMappingDatabase(path));
+    if (!active) {
+        database->openAsync();
+        pendingMappings.push_back({true, path, std::move(database)});
+        return;
+    }
+    addDatabase(std::move(database));
+}
+
+void GLFWJoystickManager::addDatabase(std::unique_ptr<GamepadMappingDatabase> database) {
+    if (!database->waitForOpen())
         return;
-    std::string line;
-    while (std::getline(fs, line)) {
-        if (!line.empty())
-            loadMappings(line);
+    database->setLoadOrder(mappingPrecedence.next());
+    mappingDatabases.push_back(std::move(database));
+    // Mappings are applied per GUID once a joystick with it is connected
+    for (int i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; i++) {
+        if (glfwJoystickPresent(i))
+            applyDatabaseMappings(i);
+    }
+}
+
+void GLFWJoystickManager::applyDatabaseMappings(int joystick) {
+    const char* guid = glfwGetJoystickGUID(joystick);
+    if (guid == nullptr)
+        return;
+    for (auto& database : mappingDatabases) {
+        if (!mappingPrecedence.allowsDatabase(guid, *database))
+            continue;
+        database->applyMappings(guid, [](std::string const& mapping) {
+            glfwUpdateGamepadMappings(mapping.c_str());
+        });
     }
 }
 
 void GLFWJoystickManager::loadMappings(const std::string &content) {
+    if (!active) {
+        pendingMappings.push_back({false, content, nullptr});
+        return;
+    }
+    mappingPrecedence.addInline(content);
     glfwUpdateGamepadMappings(content.c_str());
 }
 
@@ -39,8 +98,15 @@ int GLFWJoystickManager::nextUnassignedUserId() {
 }
 
 void GLFWJoystickManager::update(GLFWGameWindow* window) {
-    if (focusedWindow != window)
+    if (!active) {
+        if (window == nullptr || !window->hasGamepadCallbacks())
+            return;
+        activate();
+    }
+    if (focusedWindow != window || connectedJoysticks.empty())
         return;
+    GameWindowTrace::Scope trace("gamepadUpdate");
+    window->stats.gamepadPolls.fetch_add(1, std::memory_order_relaxed);
 
     for (auto& j : connectedJoysticks) {
         GLFWgamepadstate state;
@@ -71,14 +137,15 @@ void GLFWJoystickManager::update() {
 
 void GLFWJoystickManager::addWindow(GLFWGameWindow* window) {
     windows.insert(window);
-    if (windows.size() == 1) {
+    if (!active) {
+        if (!window->hasGamepadCallbacks())
+            return;
+        // activate scans the joysticks as well
+        activate();
+    } else if (windows.size() == 1) {
         // First window created poll all joysticks for valid mappings etc.
         // Doing this earlier can cause unintenional errors if muliple mapping are added before the first window is created
-        for (int i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; i++) {
-            if (glfwJoystickPresent(i)) {
-                _glfwJoystickCallback(i, GLFW_CONNECTED);
-            }
-        }
+        scanJoysticks();
     } else {
         // Only newly added window gets the events
         for (auto& joystick : connectedJoysticks)
@@ -101,11 +168,15 @@ void GLFWJoystickManager::_glfwJoystickCallback(int joystick, int action) {
     auto js = connectedJoysticks.find(joystick);
     int userId;
     if (action == GLFW_CONNECTED) {
+        applyDatabaseMappings(joystick);
         if (!glfwJoystickIsGamepad(joystick)) {
             if (windows.empty()) {
                 // No Warning before first window is created
                 return;
             }
+            // Counted once, the manager stats sum up the windows
+            auto counted = focusedWindow != nullptr ? focusedWindow : *windows.begin();
+            counted->stats.gamepadMappingMisses.fetch_add(1, std::memory_order_relaxed);
             int axis, hats, buttons;
             if (!glfwGetJoystickAxes(joystick, &axis)) {
                 axis = 0;
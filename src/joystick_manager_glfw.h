@@ -2,8 +2,10 @@
 
 #include <unordered_set>
 #include <unordered_map>
+#include <memory>
 #include <GLFW/glfw3.h>
 #include <game_window.h>
+#include "gamepad_mapping_database.h"
 
 class GLFWGameWindow;
 
@@ -17,6 +19,17 @@ private:
         JoystickInfo(int id) : userId(id) {}
     };
 
+    struct PendingMapping {
+        bool isFile;
+        std::string value;
+        // Files are loaded in the background until the manager is activated
+        std::unique_ptr<GamepadMappingDatabase> database;
+    };
+
+    static bool active;
+    static std::vector<PendingMapping> pendingMappings;
+    static std::vector<std::unique_ptr<GamepadMappingDatabase>> mappingDatabases;
+    static GamepadMappingPrecedence mappingPrecedence;
     static std::unordered_set<GLFWGameWindow*> windows;
     static GLFWGameWindow* focusedWindow;
     static std::unordered_map<int, JoystickInfo> connectedJoysticks;
@@ -26,6 +39,11 @@ private:
 
     static void _glfwJoystickCallback(int joystick, int action);
 
+    static void activate();
+    static void scanJoysticks();
+    static void applyDatabaseMappings(int joystick);
+    static void addDatabase(std::unique_ptr<GamepadMappingDatabase> database);
+
     static GamepadButtonId mapButtonId(int id);
     static GamepadAxisId mapAxisId(int id);
 
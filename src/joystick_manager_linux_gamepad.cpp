@@ -1,63 +1,240 @@
 #include "joystick_manager_linux_gamepad.h"
 
-#include <fstream>
+#include <algorithm>
+#include <cstdlib>
 #include <gamepad/joystick_manager_factory.h>
 #include <gamepad/joystick.h>
-#include "window_with_linux_gamepad.h"
+#include "native/window_with_linux_gamepad.h"
 #include <sstream>
 #include <gamepad/gamepad_mapping.h>
 #include "joystick_manager.h"
+#include "thread_options.h"
+#include "startup_timings.h"
 #include <game_window_manager.h>
 
 LinuxGamepadJoystickManager LinuxGamepadJoystickManager::instance;
 
-LinuxGamepadJoystickManager::LinuxGamepadJoystickManager() : joystickManager(gamepad::JoystickManagerFactory::create()),
-                                                             gamepadManager(*joystickManager) {
-    using namespace std::placeholders;
-    gamepadManager.onGamepadConnected.add(std::bind(&LinuxGamepadJoystickManager::onGamepadState, this, _1, true));
-    gamepadManager.onGamepadDisconnected.add(std::bind(&LinuxGamepadJoystickManager::onGamepadState, this, _1, false));
-    gamepadManager.onGamepadButton.add(std::bind(&LinuxGamepadJoystickManager::onGamepadButton, this, _1, _2, _3));
-    gamepadManager.onGamepadAxis.add(std::bind(&LinuxGamepadJoystickManager::onGamepadAxis, this, _1, _2, _3));
+// Without connected gamepads the devices are only polled for hotplug events
+static const std::chrono::milliseconds hotplugPollInterval(250);
 
-    loadMappingsFromFile("gamecontrollerdb.txt");
+LinuxGamepadJoystickManager::LinuxGamepadJoystickManager() {
+    // The joystick manager is created once a window registers a gamepad callback, see initialize
+    pendingMappings.push_back({true, "gamecontrollerdb.txt", nullptr});
+}
+
+LinuxGamepadJoystickManager::~LinuxGamepadJoystickManager() {
+    stopSamplingThread();
+}
+
+static bool ReadEnvFlag(const char* name, bool def = false) {
+    auto val = getenv(name);
+    if(!val) {
+        return def;
+    }
+    std::string sval = val;
+    return sval == "true" || sval == "1" || sval == "on";
+}
+
+void LinuxGamepadJoystickManager::preloadMappings() {
+    std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
+    for (auto& mapping : pendingMappings) {
+        if (mapping.isFile && !mapping.database) {
+            mapping.database.reset(new GamepadMappingDatabase(mapping.value));
+            mapping.database->openAsync();
+        }
+    }
 }
 
 void LinuxGamepadJoystickManager::initialize() {
+    std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
     if (!initialized) {
+        StartupTimings::Scope timing("initializeGamepads");
         initialized = true;
+        joystickManager = gamepad::JoystickManagerFactory::create();
+        // Registered before the gamepad manager so the mappings are known when it creates the gamepad
+        joystickManager->onJoystickConnected.add([this](gamepad::Joystick* joystick) {
+            applyDatabaseMappings(joystick->getGUID());
+        });
+        gamepadManager.reset(new gamepad::GamepadManager(*joystickManager));
+        using namespace std::placeholders;
+        gamepadManager->onGamepadConnected.add(std::bind(&LinuxGamepadJoystickManager::onGamepadState, this, _1, true));
+        gamepadManager->onGamepadDisconnected.add(std::bind(&LinuxGamepadJoystickManager::onGamepadState, this, _1, false));
+        gamepadManager->onGamepadButton.add(std::bind(&LinuxGamepadJoystickManager::onGamepadButton, this, _1, _2, _3));
+        gamepadManager->onGamepadAxis.add(std::bind(&LinuxGamepadJoystickManager::onGamepadAxis, this, _1, _2, _3));
+
+        auto mappings = std::move(pendingMappings);
+        pendingMappings.clear();
+        for (auto& mapping : mappings) {
+            if (mapping.isFile && mapping.database)
+                addDatabase(std::move(mapping.database));
+            else if (mapping.isFile)
+                loadMappingsFromFile(mapping.value);
+            else
+                loadMappings(mapping.value);
+        }
+
         joystickManager->initialize();
+        if (ReadEnvFlag("GAMEWINDOW_GAMEPAD_THREAD"))
+            startSamplingThread();
+    }
+}
+
+void LinuxGamepadJoystickManager::startSamplingThread() {
+    int rate = 1000;
+    if (auto val = getenv("GAMEWINDOW_GAMEPAD_THREAD_RATE"))
+        rate = std::max(atoi(val), 1);
+    samplingInterval = std::chrono::microseconds(1000000 / rate);
+    samplingThreadRunning = true;
+    samplingThread = std::thread(&LinuxGamepadJoystickManager::samplingThreadMain, this);
+}
+
+void LinuxGamepadJoystickManager::stopSamplingThread() {
+    if (!samplingThreadRunning)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(samplingWakeMutex);
+        samplingThreadRunning = false;
+    }
+    samplingWake.notify_all();
+    samplingThread.join();
+}
+
+void LinuxGamepadJoystickManager::samplingThreadMain() {
+    ThreadOptionsManager::apply(ThreadRole::GAMEPAD);
+    // linux-gamepad owns the evdev descriptors, so sample them at a fixed rate instead of waiting on them
+    auto next = std::chrono::steady_clock::now();
+    while (samplingThreadRunning) {
+        bool idle;
+        {
+            std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
+            GameWindowTrace::Scope trace("gamepadSample");
+            joystickManager->poll();
+            idle = gamepads.empty();
+            // removeWindow takes the lock, so the focused window or the first one is alive here
+            WindowWithLinuxJoystick* window = focusedWindow.load();
+            if (window == nullptr && !windows.empty())
+                window = *windows.begin();
+            if (window)
+                window->stats.gamepadPolls.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Events the main thread had no room for yet
+        eventQueue.flush();
+        ThreadOptionsManager::apply(ThreadRole::GAMEPAD);
+        auto now = std::chrono::steady_clock::now();
+        next = idle ? now + hotplugPollInterval : std::max(next + samplingInterval, now);
+        std::unique_lock<std::mutex> lock(samplingWakeMutex);
+        samplingWake.wait_until(lock, next, [this]() { return !samplingThreadRunning; });
     }
 }
 
 void LinuxGamepadJoystickManager::update(WindowWithLinuxJoystick* window) {
-    if (focusedWindow != window)
+    if (!initialized) {
+        if (!window->hasGamepadCallbacks())
+            return;
+        initialize();
+    }
+    GameWindowTrace::Scope trace("gamepadUpdate");
+    if (samplingThreadRunning) {
+        dispatchQueuedEvents();
+        return;
+    }
+    if (focusedWindow.load() != window)
         return;
 
-    initialize();
+    if (gamepads.empty()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now < nextHotplugPoll)
+            return;
+        nextHotplugPoll = now + hotplugPollInterval;
+    }
+    window->stats.gamepadPolls.fetch_add(1, std::memory_order_relaxed);
     joystickManager->poll();
 }
 
-void LinuxGamepadJoystickManager::loadMappingsFromFile(std::string const& path) {
-    std::ifstream fs(path);
-    if (!fs)
+void LinuxGamepadJoystickManager::dispatchQueuedEvents() {
+    if (!samplingThreadRunning)
         return;
-    std::string line;
-    while (std::getline(fs, line)) {
-        if (!line.empty() && line[0] != '#') {
-            try {
-                gamepadManager.addMapping(line);
-            } catch (std::exception& e) {
-                printf("Invalid mapping in %s: %s\n", path.c_str(), e.what());
+    GamepadEvent ev;
+    while (eventQueue.pop(ev))
+        dispatchEvent(ev);
+}
+
+void LinuxGamepadJoystickManager::dispatchEvent(GamepadEvent const& ev) {
+    switch (ev.type) {
+        case GamepadEvent::Type::STATE: {
+            std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
+            if (ev.value != 0.0f) {
+                // Handled here instead of on the sampling thread, it calls into the manager and may recreate the gamepad
+                auto gp = std::find_if(gamepads.begin(), gamepads.end(), [&](gamepad::Gamepad* g) { return g->getIndex() == ev.index; });
+                if (gp != gamepads.end())
+                    warnOnMissingGamePadMapping(*gp);
             }
+            for (auto window : windows)
+                window->onGamepadState(ev.index, ev.value != 0.0f, ev.timeNs);
+            break;
         }
+        case GamepadEvent::Type::BUTTON:
+            if (auto window = focusedWindow.load())
+                window->onGamepadButton(ev.index, (GamepadButtonId) ev.id, ev.value != 0.0f, ev.timeNs);
+            break;
+        case GamepadEvent::Type::AXIS:
+            if (auto window = focusedWindow.load())
+                window->onGamepadAxis(ev.index, (GamepadAxisId) ev.id, ev.value, ev.timeNs);
+            break;
+    }
+}
+
+void LinuxGamepadJoystickManager::loadMappingsFromFile(std::string const& path) {
+    std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
+    std::unique_ptr<GamepadMappingDatabase> database(new GamepadMappingDatabase(path));
+    if (!initialized) {
+        database->openAsync();
+        pendingMappings.push_back({true, path, std::move(database)});
+        return;
+    }
+    addDatabase(std::move(database));
+}
+
+void LinuxGamepadJoystickManager::addDatabase(std::unique_ptr<GamepadMappingDatabase> database) {
+    if (!database->waitForOpen())
+        return;
+    database->setLoadOrder(mappingPrecedence.next());
+    mappingDatabases.push_back(std::move(database));
+    // Mappings are applied per GUID once a joystick with it is connected
+    for (gamepad::Gamepad* gp : gamepads)
+        applyDatabaseMappings(gp->getJoystick().getGUID());
+}
+
+void LinuxGamepadJoystickManager::applyDatabaseMappings(std::string const& guid) {
+    for (auto& database : mappingDatabases) {
+        if (!mappingPrecedence.allowsDatabase(guid, *database))
+            continue;
+        database->applyMappings(guid, [&](std::string const& mapping) {
+            addMapping(mapping, database->getPath());
+        });
+    }
+}
+
+void LinuxGamepadJoystickManager::addMapping(std::string const& mapping, std::string const& source) {
+    try {
+        gamepadManager->addMapping(mapping);
+    } catch (std::exception& e) {
+        printf("Invalid mapping in %s: %s\n", source.c_str(), e.what());
     }
 }
 
 void LinuxGamepadJoystickManager::loadMappings(const std::string &content) {
+    std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
+    if (!initialized) {
+        pendingMappings.push_back({false, content, nullptr});
+        return;
+    }
+    mappingPrecedence.addInline(content);
     for (size_t i = 0; i < content.length(); ) {
         size_t j = content.find('\n', i);
-        std::string line = content.substr(i,  j);
-        gamepadManager.addMapping(line);
+        size_t length = (j == std::string::npos ? content.length() : j) - i;
+        if (length > 0 && content[i] != '#')
+            gamepadManager->addMapping(content.substr(i, length));
         if (j == std::string::npos) {
             // last line
             break;
@@ -67,7 +244,9 @@ void LinuxGamepadJoystickManager::loadMappings(const std::string &content) {
 }
 
 void LinuxGamepadJoystickManager::addWindow(WindowWithLinuxJoystick* window) {
-    initialize();
+    if (window->hasGamepadCallbacks())
+        initialize();
+    std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
     windows.insert(window);
     if (windows.size() == 1) {
         // First window created poll all joysticks for valid mappings etc.
@@ -84,24 +263,32 @@ void LinuxGamepadJoystickManager::addWindow(WindowWithLinuxJoystick* window) {
 }
 
 void LinuxGamepadJoystickManager::removeWindow(WindowWithLinuxJoystick* window) {
+    std::lock_guard<std::recursive_mutex> lock(gamepadMutex);
     windows.erase(window);
+    focusedWindow.compare_exchange_strong(window, nullptr);
 }
 
 void LinuxGamepadJoystickManager::onWindowFocused(WindowWithLinuxJoystick* window, bool focused) {
     if (focused)
         focusedWindow = window;
-    else if (focusedWindow == window /* && !focused */)
-        focusedWindow = nullptr;
+    else
+        focusedWindow.compare_exchange_strong(window, nullptr);
 }
 
 void LinuxGamepadJoystickManager::onGamepadState(gamepad::Gamepad* gp, bool connected) {
     if (connected) {
-        warnOnMissingGamePadMapping(gp);
         gamepads.insert(gp);
+        // The sampling thread leaves it to dispatchEvent on the main thread
+        if (!samplingThreadRunning)
+            warnOnMissingGamePadMapping(gp);
     }
     else
         gamepads.erase(gp);
 
+    if (samplingThreadRunning) {
+        eventQueue.push({GamepadEvent::Type::STATE, GameWindowTrace::now(), gp->getIndex(), 0, connected ? 1.0f : 0.0f});
+        return;
+    }
     for (auto window : windows)
         window->onGamepadState(gp->getIndex(), connected);
 }
@@ -111,6 +298,11 @@ void LinuxGamepadJoystickManager::warnOnMissingGamePadMapping(gamepad::Gamepad*
             // No Warning before first window is created
             return;
         }
+        // Counted once, the manager stats sum up the windows
+        auto counted = focusedWindow.load();
+        if (counted == nullptr)
+            counted = *windows.begin();
+        counted->stats.gamepadMappingMisses.fetch_add(1, std::memory_order_relaxed);
         if (!JoystickManager::handleMissingGamePadMapping("Unknown", gp->getJoystick().getGUID(), 4, 12, 1, [&](std::string mapping) {
             GameWindowManager::getManager()->addGamePadMapping(mapping);
             if (gp->getMapping().mappings.empty()) {
@@ -132,13 +324,21 @@ void LinuxGamepadJoystickManager::warnOnMissingGamePadMapping(gamepad::Gamepad*
 }
 
 void LinuxGamepadJoystickManager::onGamepadButton(gamepad::Gamepad* gp, gamepad::GamepadButton btn, bool state) {
-    if (focusedWindow != nullptr)
-        focusedWindow->onGamepadButton(gp->getIndex(), mapButtonId(btn), state);
+    if (samplingThreadRunning) {
+        eventQueue.push({GamepadEvent::Type::BUTTON, GameWindowTrace::now(), gp->getIndex(), (int) mapButtonId(btn), state ? 1.0f : 0.0f});
+        return;
+    }
+    if (auto window = focusedWindow.load())
+        window->onGamepadButton(gp->getIndex(), mapButtonId(btn), state);
 }
 
 void LinuxGamepadJoystickManager::onGamepadAxis(gamepad::Gamepad* gp, gamepad::GamepadAxis axis, float value) {
-    if (focusedWindow != nullptr)
-        focusedWindow->onGamepadAxis(gp->getIndex(), mapAxisId(axis), value);
+    if (samplingThreadRunning) {
+        eventQueue.push({GamepadEvent::Type::AXIS, GameWindowTrace::now(), gp->getIndex(), (int) mapAxisId(axis), value});
+        return;
+    }
+    if (auto window = focusedWindow.load())
+        window->onGamepadAxis(gp->getIndex(), mapAxisId(axis), value);
 }
 
 GamepadButtonId LinuxGamepadJoystickManager::mapButtonId(gamepad::GamepadButton id) {
@@ -3,11 +3,18 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
 #include <game_window.h>
 #include <gamepad/gamepad_ids.h>
 #include <gamepad/gamepad.h>
 #include <gamepad/joystick_manager.h>
 #include <gamepad/gamepad_manager.h>
+#include "gamepad_event_queue.h"
+#include "gamepad_mapping_database.h"
 
 class WindowWithLinuxJoystick;
 
@@ -16,15 +23,46 @@ class LinuxGamepadJoystickManager {
 private:
     bool initialized = false;
     std::unordered_set<WindowWithLinuxJoystick*> windows;
-    WindowWithLinuxJoystick* focusedWindow;
+    // Read by the sampling thread mode dispatch and the gamepad callbacks, cleared when the window is removed
+    std::atomic<WindowWithLinuxJoystick*> focusedWindow {nullptr};
     std::unordered_set<gamepad::Gamepad*> gamepads;
     std::shared_ptr<gamepad::JoystickManager> joystickManager;
-    gamepad::GamepadManager gamepadManager;
+    std::unique_ptr<gamepad::GamepadManager> gamepadManager;
     std::vector<std::shared_ptr<gamepad::GamepadMapping>> unknownmappings;
 
+    // Mappings added before any window wanted gamepad events, applied by initialize
+    struct PendingMapping {
+        bool isFile;
+        std::string value;
+        // Started by preloadMappings or loadMappingsFromFile
+        std::unique_ptr<GamepadMappingDatabase> database;
+    };
+    std::vector<PendingMapping> pendingMappings;
+    std::vector<std::unique_ptr<GamepadMappingDatabase>> mappingDatabases;
+    GamepadMappingPrecedence mappingPrecedence;
+    std::chrono::steady_clock::time_point nextHotplugPoll;
+
+    // Optional background thread sampling the devices independent of the frame rate
+    std::recursive_mutex gamepadMutex;
+    std::thread samplingThread;
+    std::atomic<bool> samplingThreadRunning {false};
+    std::chrono::microseconds samplingInterval;
+    std::mutex samplingWakeMutex;
+    std::condition_variable samplingWake;
+    GamepadEventQueue eventQueue;
+
+    void startSamplingThread();
+    void stopSamplingThread();
+    void samplingThreadMain();
+    void dispatchEvent(GamepadEvent const& ev);
+
     static GamepadButtonId mapButtonId(gamepad::GamepadButton id);
     static GamepadAxisId mapAxisId(gamepad::GamepadAxis id);
 
+    void applyDatabaseMappings(std::string const& guid);
+    void addMapping(std::string const& mapping, std::string const& source);
+    void addDatabase(std::unique_ptr<GamepadMappingDatabase> database);
+
     void onGamepadState(gamepad::Gamepad* gp, bool connected);
     void warnOnMissingGamePadMapping(gamepad::Gamepad* gp);
     void onGamepadButton(gamepad::Gamepad* gp, gamepad::GamepadButton btn, bool state);
@@ -35,13 +73,21 @@ public:
 
     LinuxGamepadJoystickManager();
 
+    ~LinuxGamepadJoystickManager();
+
     void initialize();
 
+    // Loads the queued mapping files in the background, not done by the constructor as it runs during static initialization
+    void preloadMappings();
+
     void loadMappingsFromFile(std::string const& path);
     void loadMappings(std::string const& content);
 
     void update(WindowWithLinuxJoystick* window);
 
+    // Dispatches the events collected by the sampling thread, does nothing if it isn't used
+    void dispatchQueuedEvents();
+
     void addWindow(WindowWithLinuxJoystick* window);
     void removeWindow(WindowWithLinuxJoystick* window);
 
@@ -0,0 +1,24 @@
+#include "main_thread_tasks.h"
+
+std::mutex MainThreadTasks::mutex;
+std::deque<std::function<void ()>> MainThreadTasks::tasks;
+std::atomic<bool> MainThreadTasks::pending {false};
+
+void MainThreadTasks::post(std::function<void ()> task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+    pending = true;
+}
+
+void MainThreadTasks::run() {
+    if (!pending)
+        return;
+    std::deque<std::function<void ()>> queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.swap(tasks);
+        pending = false;
+    }
+    for (auto& task : queued)
+        task();
+}
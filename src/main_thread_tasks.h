@@ -0,0 +1,22 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Work which has to run on the thread owning the window system, see GameWindowManager::runMainThreadTasks
+class MainThreadTasks {
+
+private:
+    static std::mutex mutex;
+    static std::deque<std::function<void ()>> tasks;
+    static std::atomic<bool> pending;
+
+public:
+    static void post(std::function<void ()> task);
+
+    // Runs the tasks queued before the call, tasks posted meanwhile run on the next call
+    static void run();
+
+};
@@ -0,0 +1,135 @@
+#include "monitor_cache_glfw.h"
+
+#include <algorithm>
+#include <cstdio>
+
+std::unordered_map<GLFWmonitor*, std::vector<FullscreenMode>> GLFWMonitorCache::modes;
+unsigned GLFWMonitorCache::generation;
+
+void GLFWMonitorCache::init() {
+    glfwSetMonitorCallback(_glfwMonitorCallback);
+}
+
+void GLFWMonitorCache::_glfwMonitorCallback(GLFWmonitor* monitor, int event) {
+    invalidate();
+}
+
+void GLFWMonitorCache::invalidate() {
+    modes.clear();
+    generation++;
+}
+
+std::vector<MonitorInfo> GLFWMonitorCache::getMonitors() {
+    std::vector<MonitorInfo> result;
+    int count = 0;
+    auto monitors = glfwGetMonitors(&count);
+    auto primary = glfwGetPrimaryMonitor();
+    for (int i = 0; i < count; i++) {
+        MonitorInfo info;
+        info.id = i;
+        auto name = glfwGetMonitorName(monitors[i]);
+        if (name)
+            info.name = name;
+        glfwGetMonitorPos(monitors[i], &info.x, &info.y);
+        if (auto mode = glfwGetVideoMode(monitors[i])) {
+            info.width = mode->width;
+            info.height = mode->height;
+            info.refreshRate = (float) mode->refreshRate;
+        }
+        float scaley;
+        glfwGetMonitorContentScale(monitors[i], &info.scale, &scaley);
+        info.primary = monitors[i] == primary;
+        result.push_back(std::move(info));
+    }
+    return result;
+}
+
+GLFWmonitor* GLFWMonitorCache::getMonitor(int id) {
+    int count = 0;
+    auto monitors = glfwGetMonitors(&count);
+    if (id < 0 || id >= count)
+        return nullptr;
+    return monitors[id];
+}
+
+int GLFWMonitorCache::getMonitorId(GLFWmonitor* monitor) {
+    int count = 0;
+    auto monitors = glfwGetMonitors(&count);
+    for (int i = 0; i < count; i++) {
+        if (monitors[i] == monitor)
+            return i;
+    }
+    return -1;
+}
+
+GLFWmonitor* GLFWMonitorCache::getMonitorForWindow(GLFWwindow* window) {
+    if (auto monitor = glfwGetWindowMonitor(window))
+        return monitor;
+    int wx, wy, ww, wh;
+    glfwGetWindowPos(window, &wx, &wy);
+    glfwGetWindowSize(window, &ww, &wh);
+    int count = 0;
+    auto monitors = glfwGetMonitors(&count);
+    GLFWmonitor* best = glfwGetPrimaryMonitor();
+    long bestArea = 0;
+    for (int i = 0; i < count; i++) {
+        auto mode = glfwGetVideoMode(monitors[i]);
+        if (!mode)
+            continue;
+        int mx, my;
+        glfwGetMonitorPos(monitors[i], &mx, &my);
+        long overlapX = std::max(0, std::min(wx + ww, mx + mode->width) - std::max(wx, mx));
+        long overlapY = std::max(0, std::min(wy + wh, my + mode->height) - std::max(wy, my));
+        if (overlapX * overlapY > bestArea) {
+            bestArea = overlapX * overlapY;
+            best = monitors[i];
+        }
+    }
+    return best;
+}
+
+std::vector<FullscreenMode> const& GLFWMonitorCache::getModes(GLFWmonitor* monitor) {
+    auto it = modes.find(monitor);
+    if (it != modes.end())
+        return it->second;
+    auto& list = modes[monitor];
+    int nModes = 0;
+    auto videoModes = monitor ? glfwGetVideoModes(monitor, &nModes) : nullptr;
+    if (videoModes) {
+        list.reserve(nModes);
+        for (int j = 0; j < nModes; j++) {
+            FullscreenMode mode;
+            mode.id = j;
+            mode.width = videoModes[j].width;
+            mode.height = videoModes[j].height;
+            mode.refreshRate = (float) videoModes[j].refreshRate;
+            mode.description = getDescription(mode);
+            list.push_back(std::move(mode));
+        }
+    }
+    return list;
+}
+
+int GLFWMonitorCache::findMode(GLFWmonitor* monitor, GLFWvidmode const& mode) {
+    for (auto& m : getModes(monitor)) {
+        if (m.width == mode.width && m.height == mode.height && m.refreshRate == (float) mode.refreshRate)
+            return m.id;
+    }
+    return -1;
+}
+
+bool GLFWMonitorCache::isValidMode(GLFWmonitor* monitor, FullscreenMode const& mode) {
+    auto& list = getModes(monitor);
+    if (mode.id < 0 || mode.id >= (int) list.size())
+        return false;
+    // Modes without size information only carry the description
+    if (mode.width == 0 && mode.height == 0)
+        return mode.description == list[mode.id].description;
+    return list[mode.id].sameMode(mode);
+}
+
+std::string GLFWMonitorCache::getDescription(FullscreenMode const& mode) {
+    char desc[64];
+    snprintf(desc, sizeof(desc), "%dx%d @ %d", mode.width, mode.height, (int) mode.refreshRate);
+    return desc;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <GLFW/glfw3.h>
+#include <game_window.h>
+
+// Video modes per monitor, enumerated once and invalidated when monitors are connected or disconnected
+class GLFWMonitorCache {
+
+private:
+    static std::unordered_map<GLFWmonitor*, std::vector<FullscreenMode>> modes;
+    static unsigned generation;
+
+    static void _glfwMonitorCallback(GLFWmonitor* monitor, int event);
+
+    // Stored in the cached modes once, so comparisons and getters don't format it again
+    static std::string getDescription(FullscreenMode const& mode);
+
+public:
+    static void init();
+
+    static void invalidate();
+
+    // Changes whenever the cache is invalidated
+    static unsigned getGeneration() { return generation; }
+
+    // Monitor ids are the index in glfwGetMonitors and only valid until a monitor is connected or disconnected
+    static std::vector<MonitorInfo> getMonitors();
+    static GLFWmonitor* getMonitor(int id);
+    static int getMonitorId(GLFWmonitor* monitor);
+
+    // Monitor with the largest overlap with the window, the primary monitor if there is none
+    static GLFWmonitor* getMonitorForWindow(GLFWwindow* window);
+
+    static std::vector<FullscreenMode> const& getModes(GLFWmonitor* monitor);
+
+    // Returns the id of the cached mode matching the video mode or -1
+    static int findMode(GLFWmonitor* monitor, GLFWvidmode const& mode);
+
+    // Checks that the mode still refers to the same entry of the cached list
+    static bool isValidMode(GLFWmonitor* monitor, FullscreenMode const& mode);
+
+};
@@ -0,0 +1,86 @@
+#include "monitor_cache_sdl3.h"
+
+#include <cstdio>
+
+std::unordered_map<SDL_DisplayID, SDL3MonitorCache::DisplayModes> SDL3MonitorCache::displays;
+
+void SDL3MonitorCache::invalidate() {
+    displays.clear();
+}
+
+void SDL3MonitorCache::handleEvent(SDL_Event const& ev) {
+    switch (ev.type) {
+    case SDL_EVENT_DISPLAY_ADDED:
+    case SDL_EVENT_DISPLAY_REMOVED:
+    case SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED:
+    case SDL_EVENT_DISPLAY_DESKTOP_MODE_CHANGED:
+    case SDL_EVENT_DISPLAY_CONTENT_SCALE_CHANGED:
+        invalidate();
+        break;
+    default:
+        break;
+    }
+}
+
+SDL3MonitorCache::DisplayModes const& SDL3MonitorCache::getDisplay(SDL_DisplayID display) {
+    auto it = displays.find(display);
+    if (it != displays.end())
+        return it->second;
+    auto& entry = displays[display];
+    int nModes = 0;
+    auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
+    if (modes) {
+        entry.modes.reserve(nModes);
+        entry.displayModes.reserve(nModes);
+        for (int j = 0; j < nModes; j++) {
+            FullscreenMode mode;
+            mode.id = j;
+            mode.width = modes[j]->w;
+            mode.height = modes[j]->h;
+            mode.refreshRate = modes[j]->refresh_rate;
+            mode.pixelDensity = modes[j]->pixel_density;
+            mode.description = getDescription(mode);
+            entry.modes.push_back(std::move(mode));
+            entry.displayModes.push_back(*modes[j]);
+        }
+        SDL_free(modes);
+    }
+    return entry;
+}
+
+std::vector<FullscreenMode> const& SDL3MonitorCache::getModes(SDL_DisplayID display) {
+    return getDisplay(display).modes;
+}
+
+const SDL_DisplayMode* SDL3MonitorCache::getDisplayMode(SDL_DisplayID display, int id) {
+    auto& entry = getDisplay(display);
+    if (id < 0 || id >= (int) entry.displayModes.size())
+        return nullptr;
+    return &entry.displayModes[id];
+}
+
+int SDL3MonitorCache::findMode(SDL_DisplayID display, SDL_DisplayMode const& mode) {
+    for (auto& m : getModes(display)) {
+        if (m.width == mode.w && m.height == mode.h && m.refreshRate == mode.refresh_rate &&
+            m.pixelDensity == mode.pixel_density)
+            return m.id;
+    }
+    return -1;
+}
+
+bool SDL3MonitorCache::isValidMode(SDL_DisplayID display, FullscreenMode const& mode) {
+    auto& list = getModes(display);
+    if (mode.id < 0 || mode.id >= (int) list.size())
+        return false;
+    // Modes without size information only carry the description
+    if (mode.width == 0 && mode.height == 0)
+        return mode.description == list[mode.id].description;
+    return list[mode.id].sameMode(mode);
+}
+
+std::string SDL3MonitorCache::getDescription(FullscreenMode const& mode) {
+    // %g matches the default stream formatting of the previous descriptions
+    char desc[96];
+    snprintf(desc, sizeof(desc), "%dx%d @ %g * %g", mode.width, mode.height, mode.refreshRate, mode.pixelDensity);
+    return desc;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <SDL3/SDL.h>
+#include <game_window.h>
+
+// Fullscreen modes per display, enumerated once and invalidated by display events
+class SDL3MonitorCache {
+
+private:
+    struct DisplayModes {
+        std::vector<FullscreenMode> modes;
+        std::vector<SDL_DisplayMode> displayModes;
+    };
+
+    static std::unordered_map<SDL_DisplayID, DisplayModes> displays;
+
+    static DisplayModes const& getDisplay(SDL_DisplayID display);
+
+    // Stored in the cached modes once, so comparisons and getters don't format it again
+    static std::string getDescription(FullscreenMode const& mode);
+
+public:
+    static void invalidate();
+
+    // Invalidates the cache if the event changes the connected displays or their modes
+    static void handleEvent(SDL_Event const& ev);
+
+    static std::vector<FullscreenMode> const& getModes(SDL_DisplayID display);
+
+    static const SDL_DisplayMode* getDisplayMode(SDL_DisplayID display, int id);
+
+    // Returns the id of the cached mode matching the display mode or -1
+    static int findMode(SDL_DisplayID display, SDL_DisplayMode const& mode);
+
+    // Checks that the mode still refers to the same entry of the cached list
+    static bool isValidMode(SDL_DisplayID display, FullscreenMode const& mode);
+
+};
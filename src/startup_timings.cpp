@@ -0,0 +1,69 @@
+#include "startup_timings.h"
+#include "native/frame_trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <unistd.h>
+
+// Spans are relative to loading the library, which is close enough to the process start
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+// Only the startup is of interest, keep windows created later from growing the list forever
+static const size_t maxTimings = 256;
+
+static std::mutex timingsMutex;
+static std::vector<StartupTiming> timings;
+
+std::atomic<bool> StartupTimings::milestonesDone[(int) Milestone::COUNT];
+
+static const char* const milestoneNames[] = {"firstShow", "firstSwapBuffers"};
+
+void StartupTimings::record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    using ms = std::chrono::duration<double, std::milli>;
+    StartupTiming timing;
+    timing.name = name;
+    timing.startMs = ms(start - epoch).count();
+    timing.durationMs = ms(end - start).count();
+    timing.threadId = FrameTrace::getThreadId();
+    std::lock_guard<std::mutex> lock(timingsMutex);
+    if (timings.size() < maxTimings)
+        timings.push_back(std::move(timing));
+}
+
+std::vector<StartupTiming> StartupTimings::get() {
+    std::lock_guard<std::mutex> lock(timingsMutex);
+    return timings;
+}
+
+void StartupTimings::recordMilestone(Milestone milestone, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    if (milestonesDone[(int) milestone].exchange(true))
+        return;
+    record(milestoneNames[(int) milestone], start, end);
+    if (milestone == Milestone::FIRST_SWAP_BUFFERS) {
+        auto path = getenv("GAMEWINDOW_STARTUP_TRACE");
+        if (path && *path && !writeTrace(path))
+            fprintf(stderr, "Failed to write the startup trace to %s\n", path);
+    }
+}
+
+bool StartupTimings::writeTrace(std::string const& path) {
+    auto list = get();
+    // Timestamps in CLOCK_MONOTONIC microseconds, the same clock as other traces of the system
+    double epochUs = std::chrono::duration<double, std::micro>(epoch.time_since_epoch()).count();
+    std::ofstream fs(path, std::ios::trunc);
+    if (!fs)
+        return false;
+    char buf[512];
+    fs << "{\"traceEvents\":[";
+    snprintf(buf, sizeof(buf), "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"game-window startup\"}}", (int) getpid());
+    fs << buf;
+    for (auto& timing : list) {
+        // The names are identifiers of the library, no escaping required
+        snprintf(buf, sizeof(buf), ",\n{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%llu}",
+                 timing.name.c_str(), epochUs + timing.startMs * 1000.0, timing.durationMs * 1000.0, (int) getpid(), (unsigned long long) timing.threadId);
+        fs << buf;
+    }
+    fs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return (bool) fs;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <game_window_manager.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Spans of the manager and window initialization, see GameWindowManager::getStartupTimings
+class StartupTimings {
+
+public:
+    class Scope {
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit Scope(const char* name) : name(name), start(std::chrono::steady_clock::now()) {}
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() {
+            record(name, start, std::chrono::steady_clock::now());
+        }
+    };
+
+    enum class Milestone {
+        FIRST_SHOW, FIRST_SWAP_BUFFERS, COUNT
+    };
+
+    // Records only the first call of the process, later calls cost a relaxed load
+    class MilestoneScope {
+        Milestone milestone;
+        bool pending;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit MilestoneScope(Milestone milestone) : milestone(milestone), pending(isPending(milestone)) {
+            if (pending)
+                start = std::chrono::steady_clock::now();
+        }
+
+        MilestoneScope(MilestoneScope const&) = delete;
+        MilestoneScope& operator=(MilestoneScope const&) = delete;
+
+        ~MilestoneScope() {
+            if (pending)
+                recordMilestone(milestone, start, std::chrono::steady_clock::now());
+        }
+    };
+
+    static void record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    static bool isPending(Milestone milestone) {
+        return !milestonesDone[(int) milestone].load(std::memory_order_relaxed);
+    }
+
+    // The trace of $GAMEWINDOW_STARTUP_TRACE is written once the first frame was swapped
+    static void recordMilestone(Milestone milestone, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    static std::vector<StartupTiming> get();
+
+    // Chrome trace event JSON, opens in chrome://tracing and ui.perfetto.dev
+    static bool writeTrace(std::string const& path);
+
+private:
+    static std::atomic<bool> milestonesDone[(int) Milestone::COUNT];
+
+};
@@ -0,0 +1,156 @@
+#include "thread_options.h"
+#include <game_window_manager.h>
+#include "diagnostics.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const int roleCount = (int) ThreadRole::GAMEPAD + 1;
+
+static std::mutex optionsMutex;
+static ThreadOptions roleOptions[roleCount];
+// 0 means the role was never configured and the thread keeps the inherited scheduling
+static std::atomic<unsigned> generation[roleCount];
+static thread_local unsigned appliedGeneration[roleCount];
+// Set when an applied generation changed the policy or nice level, DEFAULT then restores them
+static thread_local bool changedPolicy[roleCount];
+static thread_local bool changedNiceLevel[roleCount];
+
+static const char* getRoleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::EVENTS: return "events";
+        case ThreadRole::RENDER: return "render";
+        case ThreadRole::GAMEPAD: return "gamepad";
+    }
+    return "unknown";
+}
+
+namespace {
+    // Formatted on the diagnostics thread, what is a literal
+    struct ThreadOptionsError {
+        ThreadRole role;
+        const char* what;
+        int err;
+
+        std::string format() const {
+            std::stringstream errormsg;
+            errormsg << "Failed to " << what << " of the " << getRoleName(role) << " thread: " << strerror(err);
+            return errormsg.str();
+        }
+    };
+}
+
+static void reportError(ThreadRole role, const char* what, int err) {
+    Diagnostics::reportDeferred(DiagnosticCode::THREAD_OPTIONS, DiagnosticSeverity::WARNING, "ThreadOptions", ThreadOptionsError {role, what, err});
+}
+
+static bool setNiceLevel(ThreadRole role, int niceLevel) {
+#ifdef __linux__
+    // On linux the nice level is a per thread attribute
+    if (setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), niceLevel) != 0) {
+#else
+    if (setpriority(PRIO_PROCESS, 0, niceLevel) != 0) {
+#endif
+        reportError(role, "set the nice level", errno);
+        return false;
+    }
+    return true;
+}
+
+static void applyOptions(ThreadRole role, ThreadOptions const& o) {
+#ifdef __linux__
+    if (!o.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : o.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+            reportError(role, "set the cpu affinity", errno);
+    }
+#endif
+
+    int policy;
+    switch (o.policy) {
+        case ThreadSchedulingPolicy::DEFAULT:
+            if (changedPolicy[(int) role]) {
+                sched_param param;
+                memset(&param, 0, sizeof(param));
+                int err = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+                if (err != 0)
+                    reportError(role, "restore the default scheduling policy", err);
+                changedPolicy[(int) role] = false;
+            }
+            if (o.setNiceLevel) {
+                setNiceLevel(role, o.niceLevel);
+                changedNiceLevel[(int) role] = true;
+            } else if (changedNiceLevel[(int) role]) {
+                setNiceLevel(role, 0);
+                changedNiceLevel[(int) role] = false;
+            }
+            return;
+        case ThreadSchedulingPolicy::OTHER: policy = SCHED_OTHER; break;
+#ifdef __linux__
+        case ThreadSchedulingPolicy::BATCH: policy = SCHED_BATCH; break;
+        case ThreadSchedulingPolicy::IDLE: policy = SCHED_IDLE; break;
+#else
+        case ThreadSchedulingPolicy::BATCH:
+        case ThreadSchedulingPolicy::IDLE: policy = SCHED_OTHER; break;
+#endif
+        case ThreadSchedulingPolicy::FIFO: policy = SCHED_FIFO; break;
+        case ThreadSchedulingPolicy::RR: policy = SCHED_RR; break;
+        default: return;
+    }
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    bool realtime = policy == SCHED_FIFO || policy == SCHED_RR;
+    if (realtime)
+        param.sched_priority = o.priority;
+    int err = pthread_setschedparam(pthread_self(), policy, &param);
+    changedPolicy[(int) role] = true;
+    if (err != 0 && realtime) {
+        // Realtime scheduling usually requires CAP_SYS_NICE or RLIMIT_RTPRIO, fall back to the nice level
+        reportError(role, "set the realtime scheduling policy, falling back to the nice level", err);
+        memset(&param, 0, sizeof(param));
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    } else if (err != 0) {
+        reportError(role, "set the scheduling policy", err);
+    }
+    if (o.setNiceLevel && (!realtime || err != 0)) {
+        setNiceLevel(role, o.niceLevel);
+        changedNiceLevel[(int) role] = true;
+    } else if (changedNiceLevel[(int) role]) {
+        setNiceLevel(role, 0);
+        changedNiceLevel[(int) role] = false;
+    }
+}
+
+void ThreadOptionsManager::setOptions(ThreadRole role, ThreadOptions options) {
+    std::lock_guard<std::mutex> lock(optionsMutex);
+    roleOptions[(int) role] = std::move(options);
+    generation[(int) role]++;
+}
+
+ThreadOptions ThreadOptionsManager::getOptions(ThreadRole role) {
+    std::lock_guard<std::mutex> lock(optionsMutex);
+    return roleOptions[(int) role];
+}
+
+void ThreadOptionsManager::apply(ThreadRole role) {
+    unsigned gen = generation[(int) role].load(std::memory_order_relaxed);
+    if (gen == appliedGeneration[(int) role])
+        return;
+    appliedGeneration[(int) role] = gen;
+    applyOptions(role, getOptions(role));
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <game_window_thread.h>
+
+class ThreadOptionsManager {
+
+public:
+    static void setOptions(ThreadRole role, ThreadOptions options);
+    static ThreadOptions getOptions(ThreadRole role);
+
+    // Applies the options of the role to the calling thread, cheap if they were already applied
+    static void apply(ThreadRole role);
+
+};
@@ -1,10 +1,16 @@
-#include "window_eglut.h"
+#include "native/window_eglut.h"
 #include "joystick_manager_linux_gamepad.h"
+#include "thread_options.h"
+#include "startup_timings.h"
+#include "diagnostics.h"
+#include "gl_debug_output.h"
 #include <game_window_manager.h>
 
 #include <cstring>
+#include <stdexcept>
 #include <sstream>
 #include <eglut.h>
+#include <EGL/egl.h>
 #define XK_MISCELLANY
 #define XK_LATIN1
 #define XK_XKB_KEYS
@@ -12,11 +18,13 @@
 
 EGLUTWindow* EGLUTWindow::currentWindow;
 
-EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, GraphicsApi api) :
+EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) :
         WindowWithLinuxJoystick(title, width, height, api), title(title), width(width), height(height),
         graphicsApi(api) {
+    if (api == GraphicsApi::VULKAN)
+        throw std::runtime_error("EGLUT doesn't support vulkan surfaces");
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     eglutInitWindowSize(width, height);
     if (graphicsApi == GraphicsApi::OPENGL_ES2)
@@ -24,7 +32,18 @@ EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, Graphi
     if (graphicsApi == GraphicsApi::OPENGL)
         eglutInitAPIMask(EGLUT_OPENGL_BIT);
 
+    // eglut picks the EGL config itself, only the granted configuration can be reported
     winId = eglutCreateWindow(title.c_str());
+    queryContextConfig();
+    // eglut can't request a debug context, drivers may still report on a regular one
+    if (options.context.debugOutput)
+        contextConfig.debugOutput = GLDebugOutput::install(api);
+    // eglut has no monitor or video mode selection, fullscreen always covers the current monitor
+    if (options.fullscreen) {
+        eglutToggleFullscreen();
+        reportedFullscreen = true;
+    }
+    waitForFirstFrame = options.hiddenUntilFirstFrame;
 
     eglutIdleFunc(_eglutIdleFunc);
     eglutDisplayFunc(_eglutDisplayFunc);
@@ -46,7 +65,7 @@ EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, Graphi
 
 EGLUTWindow::~EGLUTWindow() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     if (currentWindow == this)
         currentWindow = nullptr;
@@ -54,32 +73,137 @@ EGLUTWindow::~EGLUTWindow() {
         eglutDestroyWindow(winId);
 }
 
+void EGLUTWindow::queryContextConfig() {
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext context = eglGetCurrentContext();
+    if (display == EGL_NO_DISPLAY || context == EGL_NO_CONTEXT)
+        return;
+    EGLint configId = 0, count = 0;
+    EGLConfig config;
+    if (!eglQueryContext(display, context, EGL_CONFIG_ID, &configId))
+        return;
+    EGLint attribs[] = {EGL_CONFIG_ID, configId, EGL_NONE};
+    if (!eglChooseConfig(display, attribs, &config, 1, &count) || count != 1)
+        return;
+    eglDisplay = display;
+    eglContext = context;
+    eglConfig = config;
+    eglGetConfigAttrib(display, config, EGL_RED_SIZE, &contextConfig.redBits);
+    eglGetConfigAttrib(display, config, EGL_GREEN_SIZE, &contextConfig.greenBits);
+    eglGetConfigAttrib(display, config, EGL_BLUE_SIZE, &contextConfig.blueBits);
+    eglGetConfigAttrib(display, config, EGL_ALPHA_SIZE, &contextConfig.alphaBits);
+    eglGetConfigAttrib(display, config, EGL_DEPTH_SIZE, &contextConfig.depthBits);
+    eglGetConfigAttrib(display, config, EGL_STENCIL_SIZE, &contextConfig.stencilBits);
+    eglGetConfigAttrib(display, config, EGL_SAMPLES, &contextConfig.samples);
+    contextConfig.srgb = false;
+    contextConfig.noError = false;
+    contextConfig.debug = false;
+    contextConfig.robustness = false;
+}
+
+ContextConfig EGLUTWindow::getContextConfig() {
+    return contextConfig;
+}
+
+std::shared_ptr<GameWindowContext> EGLUTWindow::createSharedContext() {
+    if (eglContext == nullptr) {
+        Diagnostics::report(DiagnosticCode::SHARED_CONTEXT, DiagnosticSeverity::FAILURE, "EGLUT", "Failed to create a shared context: the window context is unknown");
+        return nullptr;
+    }
+    EGLint clientType = EGL_OPENGL_ES_API, clientVersion = 0;
+    eglQueryContext(eglDisplay, eglContext, EGL_CONTEXT_CLIENT_TYPE, &clientType);
+    eglQueryContext(eglDisplay, eglContext, EGL_CONTEXT_CLIENT_VERSION, &clientVersion);
+    EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, clientVersion, EGL_NONE};
+    // The current api is per thread
+    EGLenum previousApi = eglQueryAPI();
+    eglBindAPI((EGLenum) clientType);
+    EGLContext shared = eglCreateContext(eglDisplay, eglConfig, eglContext, clientType == EGL_OPENGL_ES_API ? contextAttribs : nullptr);
+    eglBindAPI(previousApi);
+    if (shared == EGL_NO_CONTEXT) {
+        std::stringstream errormsg;
+        errormsg << "Failed to create a shared context: EGL error 0x" << std::hex << eglGetError();
+        Diagnostics::report(DiagnosticCode::SHARED_CONTEXT, DiagnosticSeverity::FAILURE, "EGLUT", errormsg.str());
+        return nullptr;
+    }
+    EGLSurface surface = EGL_NO_SURFACE;
+    const char* extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+    if (extensions == nullptr || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        EGLint surfaceAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(eglDisplay, eglConfig, surfaceAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            std::stringstream errormsg;
+            errormsg << "Failed to create a pbuffer for the shared context: EGL error 0x" << std::hex << eglGetError();
+            Diagnostics::report(DiagnosticCode::SHARED_CONTEXT, DiagnosticSeverity::FAILURE, "EGLUT", errormsg.str());
+            eglDestroyContext(eglDisplay, shared);
+            return nullptr;
+        }
+    }
+    if (contextConfig.debugOutput) {
+        // The callback is per context
+        EGLDisplay previousDisplay = eglGetCurrentDisplay();
+        EGLContext previousContext = eglGetCurrentContext();
+        EGLSurface previousDraw = eglGetCurrentSurface(EGL_DRAW), previousRead = eglGetCurrentSurface(EGL_READ);
+        EGLenum currentApi = eglQueryAPI();
+        eglBindAPI((EGLenum) clientType);
+        if (eglMakeCurrent(eglDisplay, surface, surface, shared)) {
+            GLDebugOutput::install(graphicsApi);
+            eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+        eglBindAPI(currentApi);
+        if (previousContext != EGL_NO_CONTEXT)
+            eglMakeCurrent(previousDisplay, previousDraw, previousRead, previousContext);
+    }
+    return std::make_shared<EGLUTSharedContext>(eglDisplay, shared, surface, (unsigned int) clientType);
+}
+
+EGLUTSharedContext::~EGLUTSharedContext() {
+    eglDestroyContext(display, context);
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+}
+
+void EGLUTSharedContext::makeCurrent(bool active) {
+    if (active) {
+        eglBindAPI(api);
+        eglMakeCurrent(display, surface, surface, context);
+    } else {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+}
+
 void EGLUTWindow::setIcon(std::string const &iconPath) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     eglutSetWindowIcon(iconPath.c_str());
 }
 
 void EGLUTWindow::makeCurrent(bool active) {
+    GameWindowTrace::Scope trace("makeCurrent");
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
+    if (active)
+        ThreadOptionsManager::apply(ThreadRole::RENDER);
     eglutMakeCurrent(active ? winId : -1);
 }
 
 void EGLUTWindow::show() {
+    StartupTimings::MilestoneScope timing(StartupTimings::Milestone::FIRST_SHOW);
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
-    eglutShowWindow();
+    if (waitForFirstFrame)
+        showPending = true;
+    else
+        eglutShowWindow();
     currentWindow = this;
     addWindowToGamepadManager();
 }
 
 void EGLUTWindow::close() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     currentWindow->onClose();
     int winId = currentWindow->winId;
@@ -89,12 +213,24 @@ void EGLUTWindow::close() {
 }
 
 void EGLUTWindow::pollEvents() {
+    ThreadOptionsManager::apply(ThreadRole::EVENTS);
+    GameWindowTrace::Scope trace("pollEvents");
+    StatsTimer statsTiming(*this, TimedStat::POLL_EVENTS);
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
+    if(showPending && !waitForFirstFrame) {
+        showPending = false;
+        eglutShowWindow();
+    }
     if(currentWindow->winId != -1) {
         eglutPollEvents();
     }
+    if(getFullscreen() != reportedFullscreen) {
+        reportedFullscreen = !reportedFullscreen;
+        onFullscreenChanged(reportedFullscreen);
+    }
+    dispatchGamepadEvents();
 }
 
 bool EGLUTWindow::getCursorDisabled() {
@@ -103,7 +239,7 @@ bool EGLUTWindow::getCursorDisabled() {
 
 void EGLUTWindow::setCursorDisabled(bool disabled) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     if (!disabled && !getenv("GAMEWINDOW_CENTER_CURSOR")) {
         eglutWarpMousePointer(lastMouseX,lastMouseY);
@@ -118,22 +254,36 @@ bool EGLUTWindow::getFullscreen() {
 
 void EGLUTWindow::setFullscreen(bool fullscreen) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     if (eglutGet(EGLUT_FULLSCREEN_MODE) != (fullscreen ? EGLUT_FULLSCREEN : EGLUT_WINDOWED))
         eglutToggleFullscreen();
 }
 
+FullscreenType EGLUTWindow::getFullscreenType() {
+    // eglut uses _NET_WM_STATE_FULLSCREEN and never changes the video mode
+    return FullscreenType::BORDERLESS;
+}
+
 void EGLUTWindow::swapBuffers() {
+    ThreadOptionsManager::apply(ThreadRole::RENDER);
+    StartupTimings::MilestoneScope timing(StartupTimings::Milestone::FIRST_SWAP_BUFFERS);
+    GameWindowTrace::Scope trace("swapBuffers");
+    StatsTimer statsTiming(*this, TimedStat::SWAP_BUFFERS);
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
+    FrameTimer frameTiming(*this);
     eglutSwapBuffers();
+    if (contextConfig.debugOutput)
+        GLDebugOutput::flushRepeats();
+    // The window is shown by the next pollEvents, it may be called from another thread
+    waitForFirstFrame = false;
 }
 
 void EGLUTWindow::setSwapInterval(int interval) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     eglutSwapInterval(interval);
 }
@@ -237,9 +387,7 @@ void EGLUTWindow::_eglutKeyboardFunc(char str[5], int action) {
     if (action == EGLUT_KEY_PRESS || action == EGLUT_KEY_REPEAT) {
         if (str[0] == 13 && str[1] == 0)
             str[0] = 10;
-        std::stringstream ss;
-        ss << str;
-        currentWindow->onKeyboardText(ss.str());
+        currentWindow->onKeyboardText(str);
     }
 }
 
@@ -336,7 +484,7 @@ void EGLUTWindow::_eglutKeyboardSpecialFunc(int key, int action) {
     }
 #ifndef NDEBUG
     else if (enumAction == KeyAction::PRESS){
-        GameWindowManager::getManager()->getErrorHandler()->onError("EGLUT Unknown Key", "Please check your Keyboard Layout. No Fallback Implemented");
+        Diagnostics::report(DiagnosticCode::UNKNOWN_KEY, DiagnosticSeverity::WARNING, "EGLUT Unknown Key", "Please check your Keyboard Layout. No Fallback Implemented");
     }
 #endif
 }
@@ -366,7 +514,8 @@ void EGLUTWindow::getWindowSize(int& width, int& height) const {
 
 void EGLUTWindow::setClipboardText(std::string const &text) {    
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
+    StatsCounters::increment(stats.clipboardRoundTrips);
     eglutSetClipboardText(text.c_str());
 }
@@ -1,47 +1,263 @@
-#include "window_glfw.h"
+#ifdef GAMEWINDOW_HAS_VULKAN
+// glfw3.h declares glfwCreateWindowSurface only with the vulkan header
+#define GLFW_INCLUDE_VULKAN
+#endif
+#include "native/window_glfw.h"
 #include "game_window_manager.h"
 #include "joystick_manager_glfw.h"
+#include "thread_options.h"
+#include "monitor_cache_glfw.h"
+#include "context_probe_cache.h"
+#include "gl_debug_output.h"
+#include "startup_timings.h"
+#include "diagnostics.h"
 
-#include <codecvt>
 #include <iomanip>
 #include <thread>
 #include <sstream>
 
 #include <math.h>
+#include <cstdint>
+#include <algorithm>
+
+
+// Subset of the GL enums, glfw3.h only includes the OpenGL 1.x header
+namespace GLEnum {
+    enum : unsigned int {
+        RED_BITS = 0x0D52, GREEN_BITS = 0x0D53, BLUE_BITS = 0x0D54, ALPHA_BITS = 0x0D55,
+        DEPTH_BITS = 0x0D56, STENCIL_BITS = 0x0D57, SAMPLES = 0x80A9,
+        FRAMEBUFFER = 0x8D40, BACK_LEFT = 0x0402, BACK = 0x0405, DEPTH = 0x1801, STENCIL = 0x1802,
+        FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING = 0x8210, FRAMEBUFFER_ATTACHMENT_RED_SIZE = 0x8212,
+        FRAMEBUFFER_ATTACHMENT_GREEN_SIZE = 0x8213, FRAMEBUFFER_ATTACHMENT_BLUE_SIZE = 0x8214,
+        FRAMEBUFFER_ATTACHMENT_ALPHA_SIZE = 0x8215, FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE = 0x8216,
+        FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE = 0x8217, SRGB = 0x8C40,
+        RENDERER = 0x1F01, VERSION = 0x1F02
+    };
+}
 
-GLFWGameWindow::GLFWGameWindow(const std::string& title, int width, int height, GraphicsApi api) :
-        GameWindow(title, width, height, api), width(width), height(height), windowedWidth(width), windowedHeight(height) {
-#ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
-#endif
-    glfwDefaultWindowHints();
+void GLFWGameWindow::queryContextConfig(GraphicsApi api, ContextConfig const& requested) {
+    contextConfig = ContextConfig();
+    contextConfig.noError = glfwGetWindowAttrib(window, GLFW_CONTEXT_NO_ERROR) == GLFW_TRUE;
+    contextConfig.debug = glfwGetWindowAttrib(window, GLFW_OPENGL_DEBUG_CONTEXT) == GLFW_TRUE;
+    contextConfig.robustness = glfwGetWindowAttrib(window, GLFW_CONTEXT_ROBUSTNESS) == GLFW_LOSE_CONTEXT_ON_RESET;
+
+    // glfw doesn't report the framebuffer format, ask the context for it
+    using GetIntegerv = void (*)(unsigned int, int*);
+    using GetFramebufferAttachmentParameteriv = void (*)(unsigned int, unsigned int, unsigned int, int*);
+    using GetError = unsigned int (*)();
+    auto getIntegerv = (GetIntegerv) glfwGetProcAddress("glGetIntegerv");
+    auto getAttachmentParameter = (GetFramebufferAttachmentParameteriv) glfwGetProcAddress("glGetFramebufferAttachmentParameteriv");
+    auto getError = (GetError) glfwGetProcAddress("glGetError");
+    if (getIntegerv == nullptr || getError == nullptr)
+        return;
+    int majorVersion = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR);
+    int values[6] = {};
+    if (majorVersion >= 3 && getAttachmentParameter != nullptr) {
+        unsigned int color = api == GraphicsApi::OPENGL ? GLEnum::BACK_LEFT : GLEnum::BACK;
+        getAttachmentParameter(GLEnum::FRAMEBUFFER, color, GLEnum::FRAMEBUFFER_ATTACHMENT_RED_SIZE, &values[0]);
+        getAttachmentParameter(GLEnum::FRAMEBUFFER, color, GLEnum::FRAMEBUFFER_ATTACHMENT_GREEN_SIZE, &values[1]);
+        getAttachmentParameter(GLEnum::FRAMEBUFFER, color, GLEnum::FRAMEBUFFER_ATTACHMENT_BLUE_SIZE, &values[2]);
+        getAttachmentParameter(GLEnum::FRAMEBUFFER, color, GLEnum::FRAMEBUFFER_ATTACHMENT_ALPHA_SIZE, &values[3]);
+        // Fails without changing the value if the framebuffer has no depth or stencil buffer,
+        // invalid calls are undefined behaviour in KHR_no_error contexts though
+        if (!contextConfig.noError || requested.depthBits > 0)
+            getAttachmentParameter(GLEnum::FRAMEBUFFER, GLEnum::DEPTH, GLEnum::FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &values[4]);
+        if (!contextConfig.noError || requested.stencilBits > 0)
+            getAttachmentParameter(GLEnum::FRAMEBUFFER, GLEnum::STENCIL, GLEnum::FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &values[5]);
+        int encoding = 0;
+        getAttachmentParameter(GLEnum::FRAMEBUFFER, color, GLEnum::FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING, &encoding);
+        contextConfig.srgb = encoding == GLEnum::SRGB;
+    } else {
+        // OpenGL ES 2.0
+        getIntegerv(GLEnum::RED_BITS, &values[0]);
+        getIntegerv(GLEnum::GREEN_BITS, &values[1]);
+        getIntegerv(GLEnum::BLUE_BITS, &values[2]);
+        getIntegerv(GLEnum::ALPHA_BITS, &values[3]);
+        getIntegerv(GLEnum::DEPTH_BITS, &values[4]);
+        getIntegerv(GLEnum::STENCIL_BITS, &values[5]);
+    }
+    contextConfig.redBits = values[0];
+    contextConfig.greenBits = values[1];
+    contextConfig.blueBits = values[2];
+    contextConfig.alphaBits = values[3];
+    contextConfig.depthBits = values[4];
+    contextConfig.stencilBits = values[5];
+    getIntegerv(GLEnum::SAMPLES, &contextConfig.samples);
+    // Don't leave errors of the unsupported queries to the application
+    while (getError() != 0) {
+    }
+}
+
+// Identifies the driver the probed configuration was recorded for
+static std::string getRendererString() {
+    using GetString = const unsigned char* (*)(unsigned int);
+    auto getString = (GetString) glfwGetProcAddress("glGetString");
+    if (getString == nullptr)
+        return std::string();
+    auto renderer = (const char*) getString(GLEnum::RENDERER);
+    auto version = (const char*) getString(GLEnum::VERSION);
+    std::string result = std::string(renderer ? renderer : "") + " " + (version ? version : "");
+    std::replace(result.begin(), result.end(), '\t', ' ');
+    std::replace(result.begin(), result.end(), '\n', ' ');
+    return result;
+}
+
+GLFWWindowCreation::GLFWWindowCreation(std::string title, int width, int height, GraphicsApi api, WindowOptions const& options) :
+        title(std::move(title)), width(width), height(height), api(api), options(options),
+        createWidth(width), createHeight(height) {
+    if (options.fullscreen) {
+        monitor = options.monitor != -1 ? GLFWMonitorCache::getMonitor(options.monitor) : nullptr;
+        if (monitor == nullptr)
+            monitor = glfwGetPrimaryMonitor();
+        desktop = monitor ? glfwGetVideoMode(monitor) : nullptr;
+        // Without a monitor the window is created windowed
+        if (desktop == nullptr)
+            monitor = nullptr;
+    }
+    if (monitor != nullptr) {
+        createWidth = desktop->width;
+        createHeight = desktop->height;
+        refreshRate = desktop->refreshRate;
+        auto& mode = options.mode;
+        if (options.fullscreenType == FullscreenType::EXCLUSIVE && mode.id != -1 && GLFWMonitorCache::isValidMode(monitor, mode)) {
+            auto& m = GLFWMonitorCache::getModes(monitor)[mode.id];
+            createWidth = m.width;
+            createHeight = m.height;
+            refreshRate = (int) m.refreshRate;
+        }
+    }
+    auto& config = options.context;
+    bool debug = config.debug || config.debugOutput;
+    // KHR_no_error can't be combined with debug or robust contexts, it is optional and falls back to a validating context
+    bool noError = config.noError && !debug && !config.robustness;
     if (api == GraphicsApi::OPENGL_ES2) {
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
-        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        if (noError)
+            attempts.push_back({"es3-noerror", GLFW_OPENGL_ES_API, 3, 0, GLFW_OPENGL_ANY_PROFILE, true});
+        attempts.push_back({"es3", GLFW_OPENGL_ES_API, 3, 0, GLFW_OPENGL_ANY_PROFILE, false});
+        attempts.push_back({"es2", GLFW_OPENGL_ES_API, 2, 0, GLFW_OPENGL_ANY_PROFILE, false});
     } else if (api == GraphicsApi::OPENGL) {
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
-        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        if (noError)
+            attempts.push_back({"core-noerror", GLFW_OPENGL_API, 3, 2, GLFW_OPENGL_CORE_PROFILE, true});
+        attempts.push_back({"core", GLFW_OPENGL_API, 3, 2, GLFW_OPENGL_CORE_PROFILE, false});
+        attempts.push_back({"compat", GLFW_OPENGL_API, 3, 2, GLFW_OPENGL_COMPAT_PROFILE, false});
+    } else {
+        attempts.push_back({"none", GLFW_NO_API, 0, 0, GLFW_OPENGL_ANY_PROFILE, false});
     }
-    window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
-    if (window == nullptr && api == GraphicsApi::OPENGL_ES2) {
-        // Failed to get es3 request es2
-        glfwDefaultWindowHints();
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+    defaultAttempts = attempts;
+    // Start with the configuration which succeeded last time, the failed attempts before it aren't repeated
+    if (api != GraphicsApi::VULKAN) {
+        std::stringstream key;
+        key << "v" << ContextProbeCache::formatVersion << " glfw " << glfwGetVersionString() << " api" << (int) api << (noError ? " noerror" : "")
+            << (debug ? " debug" : "") << (config.robustness ? " robust" : "");
+        cacheKey = key.str();
+        auto cached = ContextProbeCache::get(cacheKey);
+        auto sep = cached.find('\t');
+        cachedName = cached.substr(0, sep);
+        cachedRenderer = sep != std::string::npos ? cached.substr(sep + 1) : std::string();
+        std::stable_partition(attempts.begin(), attempts.end(), [&](ContextAttempt const& a) {
+            return cachedName == a.name;
+        });
+    }
+}
+
+GLFWWindowCreation::~GLFWWindowCreation() {
+    if (window != nullptr)
+        glfwDestroyWindow(window);
+}
+
+GLFWwindow* GLFWWindowCreation::tryCreateWindow(ContextAttempt const& attempt) {
+    auto& config = options.context;
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_REFRESH_RATE, refreshRate);
+    glfwWindowHint(GLFW_AUTO_ICONIFY, options.fullscreenType == FullscreenType::EXCLUSIVE ? GLFW_TRUE : GLFW_FALSE);
+    // Ignored by glfw for fullscreen windows
+    glfwWindowHint(GLFW_VISIBLE, options.hiddenUntilFirstFrame ? GLFW_FALSE : GLFW_TRUE);
+    glfwWindowHint(GLFW_RED_BITS, config.redBits);
+    glfwWindowHint(GLFW_GREEN_BITS, config.greenBits);
+    glfwWindowHint(GLFW_BLUE_BITS, config.blueBits);
+    glfwWindowHint(GLFW_ALPHA_BITS, config.alphaBits);
+    glfwWindowHint(GLFW_DEPTH_BITS, config.depthBits);
+    glfwWindowHint(GLFW_STENCIL_BITS, config.stencilBits);
+    glfwWindowHint(GLFW_SAMPLES, config.samples);
+    glfwWindowHint(GLFW_SRGB_CAPABLE, config.srgb ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_NO_ERROR, attempt.noError ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, config.debug || config.debugOutput ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_ROBUSTNESS, config.robustness ? GLFW_LOSE_CONTEXT_ON_RESET : GLFW_NO_ROBUSTNESS);
+    glfwWindowHint(GLFW_CLIENT_API, attempt.client);
+    if (attempt.client == GLFW_OPENGL_ES_API)
         glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-        window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    if (attempt.client != GLFW_NO_API) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, attempt.major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, attempt.minor);
+    }
+    if (attempt.profile == GLFW_OPENGL_CORE_PROFILE)
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, attempt.profile);
+    return glfwCreateWindow(createWidth, createHeight, title.c_str(), monitor, nullptr);
+}
+
+bool GLFWWindowCreation::step() {
+    if (window != nullptr || nextAttempt >= attempts.size())
+        return true;
+    auto& attempt = attempts[nextAttempt++];
+    {
+        StartupTimings::Scope timing("createContext");
+        window = tryCreateWindow(attempt);
     }
-    if(window == nullptr) {
+    if (window == nullptr)
+        return nextAttempt >= attempts.size();
+    if (api == GraphicsApi::VULKAN)
+        return true;
+    glfwMakeContextCurrent(window);
+    std::string renderer = getRendererString();
+    if (!reprobed && !cachedName.empty() && renderer != cachedRenderer && attempt.name != defaultAttempts[0].name) {
+        // The driver changed since the probe, configurations which failed before may succeed now
+        glfwDestroyWindow(window);
+        window = nullptr;
+        attempts = defaultAttempts;
+        nextAttempt = 0;
+        reprobed = true;
+        return false;
+    }
+    if (cachedName != attempt.name || cachedRenderer != renderer)
+        ContextProbeCache::set(cacheKey, std::string(attempt.name) + '\t' + renderer);
+    return true;
+}
+
+std::shared_ptr<GameWindow> GLFWWindowCreation::finish() {
+    if (window == nullptr) {
         // Throw an exception, otherwise it would crash due to a nullptr without any information
         const char* error = nullptr;
         glfwGetError(&error);
         throw std::runtime_error(error == nullptr ? "GLFW failed to create a window without any error message" : error);
     }
+    return std::shared_ptr<GameWindow>(new GLFWGameWindow(*this));
+}
+
+GLFWGameWindow::GLFWGameWindow(GLFWWindowCreation& creation) :
+        GameWindow(creation.title, creation.width, creation.height, creation.api), window(creation.window),
+        width(creation.width), height(creation.height), windowedWidth(creation.width), windowedHeight(creation.height),
+        hasContext(creation.api != GraphicsApi::VULKAN) {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    creation.window = nullptr;
+    auto& options = creation.options;
+    if (options.fullscreen) {
+        fullscreenMonitor = options.monitor;
+        fullscreenType = options.fullscreenType;
+        mode = options.mode;
+    }
+    if (creation.monitor != nullptr) {
+        requestFullscreen = true;
+        reportedFullscreen = true;
+        // Center the windowed position used when leaving fullscreen on the same monitor
+        int monitorX, monitorY;
+        glfwGetMonitorPos(creation.monitor, &monitorX, &monitorY);
+        windowedX = monitorX + std::max(creation.desktop->width - width, 0) / 2;
+        windowedY = monitorY + std::max(creation.desktop->height - height, 0) / 2;
+    }
+    waitForFirstFrame = options.hiddenUntilFirstFrame;
     glfwSetWindowUserPointer(window, this);
     glfwSetFramebufferSizeCallback(window, _glfwWindowSizeCallback);
     glfwSetCursorPosCallback(window, _glfwCursorPosCallback);
@@ -52,21 +268,100 @@ GLFWGameWindow::GLFWGameWindow(const std::string& title, int width, int height,
     glfwSetCharCallback(window, _glfwCharCallback);
     glfwSetWindowFocusCallback(window, _glfwWindowFocusCallback);
     glfwSetWindowContentScaleCallback(window, _glfwWindowContentScaleCallback);
-    glfwMakeContextCurrent(window);
+    glfwSetWindowPosCallback(window, _glfwWindowPosCallback);
+    if (hasContext) {
+        glfwMakeContextCurrent(window);
+        queryContextConfig(creation.api, options.context);
+        if (options.context.debugOutput)
+            contextConfig.debugOutput = GLDebugOutput::install(creation.api);
+    }
 
     setRelativeScale();
 }
 
+ContextConfig GLFWGameWindow::getContextConfig() {
+    return contextConfig;
+}
+
+std::shared_ptr<GameWindowContext> GLFWGameWindow::createSharedContext() {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    if (!hasContext)
+        return nullptr;
+    // Same context type as the window, sharing requires matching client apis
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CLIENT_API, glfwGetWindowAttrib(window, GLFW_CLIENT_API));
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, glfwGetWindowAttrib(window, GLFW_CONTEXT_CREATION_API));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MINOR));
+    glfwWindowHint(GLFW_OPENGL_PROFILE, glfwGetWindowAttrib(window, GLFW_OPENGL_PROFILE));
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, glfwGetWindowAttrib(window, GLFW_OPENGL_FORWARD_COMPAT));
+    glfwWindowHint(GLFW_CONTEXT_NO_ERROR, glfwGetWindowAttrib(window, GLFW_CONTEXT_NO_ERROR));
+    glfwWindowHint(GLFW_CONTEXT_ROBUSTNESS, glfwGetWindowAttrib(window, GLFW_CONTEXT_ROBUSTNESS));
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, glfwGetWindowAttrib(window, GLFW_OPENGL_DEBUG_CONTEXT));
+    glfwWindowHint(GLFW_DEPTH_BITS, 0);
+    glfwWindowHint(GLFW_STENCIL_BITS, 0);
+    GLFWwindow* shared = glfwCreateWindow(1, 1, "", nullptr, window);
+    if (shared == nullptr) {
+        const char* error = nullptr;
+        glfwGetError(&error);
+        Diagnostics::report(DiagnosticCode::SHARED_CONTEXT, DiagnosticSeverity::FAILURE, "GLFW", std::string("Failed to create a shared context: ") + (error ? error : "unknown error"));
+        return nullptr;
+    }
+    if (contextConfig.debugOutput) {
+        // The callback is per context
+        auto previous = glfwGetCurrentContext();
+        glfwMakeContextCurrent(shared);
+        GLDebugOutput::install(glfwGetWindowAttrib(window, GLFW_CLIENT_API) == GLFW_OPENGL_ES_API ? GraphicsApi::OPENGL_ES2 : GraphicsApi::OPENGL);
+        glfwMakeContextCurrent(previous);
+    }
+    return std::make_shared<GLFWSharedContext>(shared);
+}
+
+uint64_t GLFWGameWindow::createVulkanSurface(void* instance) {
+#ifndef GAMEWINDOW_HAS_VULKAN
+    Diagnostics::report(DiagnosticCode::VULKAN_SURFACE, DiagnosticSeverity::FAILURE, "GLFW", "Failed to create a vulkan surface: built without the vulkan headers");
+    return 0;
+#else
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    VkResult result = glfwCreateWindowSurface((VkInstance) instance, window, nullptr, &surface);
+    if (result != VK_SUCCESS) {
+        std::stringstream errormsg;
+        errormsg << "Failed to create a vulkan surface: VkResult " << result;
+        Diagnostics::report(DiagnosticCode::VULKAN_SURFACE, DiagnosticSeverity::FAILURE, "GLFW", errormsg.str());
+        return 0;
+    }
+    return (uint64_t) surface;
+#endif
+}
+
+GLFWSharedContext::~GLFWSharedContext() {
+    glfwDestroyWindow(window);
+}
+
+void GLFWSharedContext::makeCurrent(bool active) {
+    glfwMakeContextCurrent(active ? window : nullptr);
+}
+
 void GLFWGameWindow::makeCurrent(bool c) {
+    GameWindowTrace::Scope trace("makeCurrent");
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
-    glfwMakeContextCurrent(c ? window : nullptr);
+    if (c)
+        ThreadOptionsManager::apply(ThreadRole::RENDER);
+    if (hasContext)
+        glfwMakeContextCurrent(c ? window : nullptr);
 }
 
 GLFWGameWindow::~GLFWGameWindow() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     GLFWJoystickManager::removeWindow(this);
     glfwDestroyWindow(window);
@@ -78,7 +373,7 @@ void GLFWGameWindow::setIcon(std::string const& iconPath) {
 
 void GLFWGameWindow::setRelativeScale() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     int fx, fy;
     glfwGetFramebufferSize(window, &fx, &fy);
@@ -103,30 +398,32 @@ void GLFWGameWindow::getWindowSize(int& width, int& height) const {
 }
 
 void GLFWGameWindow::show() {
+    StartupTimings::MilestoneScope timing(StartupTimings::Milestone::FIRST_SHOW);
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     GLFWJoystickManager::addWindow(this);
+    if (waitForFirstFrame) {
+        showPending = true;
+        return;
+    }
     glfwShowWindow(window);
 }
 
 void GLFWGameWindow::close() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     onClose();
     glfwSetWindowShouldClose(window, GLFW_TRUE);
 }
 
-static std::string getModeDescription(const GLFWvidmode& mode) {
-    std::stringstream desc;
-    desc << mode.width << "x" << mode.height << " @ " << mode.refreshRate;
-    return desc.str();
-}
-
 void GLFWGameWindow::pollEvents() {
+    ThreadOptionsManager::apply(ThreadRole::EVENTS);
+    GameWindowTrace::Scope trace("pollEvents");
+    StatsTimer statsTiming(*this, TimedStat::POLL_EVENTS);
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     if((glfwGetWindowMonitor(window) != NULL) != requestFullscreen) {
         if(requestFullscreen) {
@@ -134,30 +431,27 @@ void GLFWGameWindow::pollEvents() {
             // convert pixels to window coordinates getRelativeScale() is 2 on macOS retina screens
             windowedWidth = width / getRelativeScale();
             windowedHeight = height / getRelativeScale();
-            GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-            int nModes = 0;
-            auto modes = glfwGetVideoModes(monitor, &nModes);
-            if(mode.id != -1 && nModes > mode.id && mode.description == getModeDescription(modes[mode.id])) {
-                glfwSetWindowMonitor(window, monitor, 0, 0, modes[mode.id].width, modes[mode.id].height, modes[mode.id].refreshRate);
-                return;
-            }
-            const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-            glfwSetWindowMonitor(window, monitor, 0, 0, mode->width, mode->height, mode->refreshRate);
+            enterFullscreen(getTargetMonitor());
         } else {
             glfwSetWindowMonitor(window, nullptr, windowedX, windowedY, windowedWidth, windowedHeight, GLFW_DONT_CARE);
+            modesetMonitor = nullptr;
+            monitorDirty = true;
         }
     } else if(pendingFullscreenModeSwitch) {
         pendingFullscreenModeSwitch = false;
-        int nModes = 0;
-        auto display = glfwGetWindowMonitor(window);
-        if(display) {
-            auto modes = glfwGetVideoModes(display, &nModes);
-            if(nModes > mode.id && mode.description == getModeDescription(modes[mode.id])) {
-                glfwSetWindowMonitor(window, display, 0, 0, modes[mode.id].width, modes[mode.id].height, modes[mode.id].refreshRate);
-            }
+        if(glfwGetWindowMonitor(window)) {
+            enterFullscreen(getTargetMonitor());
         }
     }
+    if(showPending && !waitForFirstFrame) {
+        showPending = false;
+        glfwShowWindow(window);
+    }
     glfwPollEvents();
+    if(getFullscreen() != reportedFullscreen) {
+        reportedFullscreen = !reportedFullscreen;
+        onFullscreenChanged(reportedFullscreen);
+    }
     if(resized) {
       onWindowSizeChanged(width, height);
       resized = false;
@@ -171,7 +465,7 @@ bool GLFWGameWindow::getCursorDisabled() {
 
 void GLFWGameWindow::setCursorDisabled(bool disabled) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     if (disabled) {
         if (glfwRawMouseMotionSupported())
@@ -193,30 +487,42 @@ bool GLFWGameWindow::getFullscreen() {
 
 void GLFWGameWindow::setFullscreen(bool fullscreen) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
     requestFullscreen = fullscreen;
 }
 
 void GLFWGameWindow::setClipboardText(std::string const &text) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
+    StatsCounters::increment(stats.clipboardRoundTrips);
     glfwSetClipboardString(window, text.c_str());
 }
 
 void GLFWGameWindow::swapBuffers() {
+    ThreadOptionsManager::apply(ThreadRole::RENDER);
+    StartupTimings::MilestoneScope timing(StartupTimings::Milestone::FIRST_SWAP_BUFFERS);
+    GameWindowTrace::Scope trace("swapBuffers");
+    StatsTimer statsTiming(*this, TimedStat::SWAP_BUFFERS);
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
-    glfwSwapBuffers(window);
+    FrameTimer frameTiming(*this);
+    if (hasContext)
+        glfwSwapBuffers(window);
+    if (contextConfig.debugOutput)
+        GLDebugOutput::flushRepeats();
+    // The window is shown by the next pollEvents, it may be called from another thread
+    waitForFirstFrame = false;
 }
 
 void GLFWGameWindow::setSwapInterval(int interval) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
 #endif
-    glfwSwapInterval(interval);
+    if (hasContext)
+        glfwSwapInterval(interval);
 }
 
 void GLFWGameWindow::_glfwWindowSizeCallback(GLFWwindow* window, int w, int h) {
@@ -369,6 +675,7 @@ void GLFWGameWindow::_glfwKeyCallback(GLFWwindow* window, int key, int scancode,
 #else
     if (action == GLFW_PRESS && mods & GLFW_MOD_CONTROL && key == GLFW_KEY_V) {
 #endif
+        StatsCounters::increment(user->stats.clipboardRoundTrips);
         auto clipboardString = glfwGetClipboardString(window);
         if(clipboardString != nullptr)
             user->onPaste(clipboardString);
@@ -391,7 +698,7 @@ void GLFWGameWindow::_glfwKeyCallback(GLFWwindow* window, int key, int scancode,
     else {
         if (!user->warnedButtons) {
             user->warnedButtons = true;
-            GameWindowManager::getManager()->getErrorHandler()->onError("GLFW Unknown Key", "Please check your Keyboard Layout. Falling back to scancode for unknown Keys.");
+            Diagnostics::report(DiagnosticCode::UNKNOWN_KEY, DiagnosticSeverity::WARNING, "GLFW Unknown Key", "Please check your Keyboard Layout. Falling back to scancode for unknown Keys.");
         }
         user->onKeyboard((KeyCode) scancode, enumAction);
     }
@@ -400,8 +707,31 @@ void GLFWGameWindow::_glfwKeyCallback(GLFWwindow* window, int key, int scancode,
 
 void GLFWGameWindow::_glfwCharCallback(GLFWwindow* window, unsigned int ch) {
     GLFWGameWindow* user = (GLFWGameWindow*) glfwGetWindowUserPointer(window);
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> cvt;
-    user->onKeyboardText(cvt.to_bytes(ch));
+    // Encoded by hand, wstring_convert allocates on every character. Up to 4 bytes fit the small string buffer
+    char buf[4];
+    size_t len;
+    if (ch < 0x80) {
+        buf[0] = (char) ch;
+        len = 1;
+    } else if (ch < 0x800) {
+        buf[0] = (char) (0xC0 | (ch >> 6));
+        buf[1] = (char) (0x80 | (ch & 0x3F));
+        len = 2;
+    } else if (ch < 0x10000) {
+        buf[0] = (char) (0xE0 | (ch >> 12));
+        buf[1] = (char) (0x80 | ((ch >> 6) & 0x3F));
+        buf[2] = (char) (0x80 | (ch & 0x3F));
+        len = 3;
+    } else if (ch < 0x110000) {
+        buf[0] = (char) (0xF0 | (ch >> 18));
+        buf[1] = (char) (0x80 | ((ch >> 12) & 0x3F));
+        buf[2] = (char) (0x80 | ((ch >> 6) & 0x3F));
+        buf[3] = (char) (0x80 | (ch & 0x3F));
+        len = 4;
+    } else {
+        return;
+    }
+    user->onKeyboardText(std::string(buf, len));
 }
 
 void GLFWGameWindow::_glfwWindowCloseCallback(GLFWwindow* window) {
@@ -419,6 +749,89 @@ void GLFWGameWindow::_glfwWindowFocusCallback(GLFWwindow* window, int focused) {
 void GLFWGameWindow::_glfwWindowContentScaleCallback(GLFWwindow* window, float scalex, float scaley) {
     GLFWGameWindow* user = (GLFWGameWindow*) glfwGetWindowUserPointer(window);
     user->setRelativeScale();
+    user->monitorDirty = true;
+}
+
+void GLFWGameWindow::enterFullscreen(GLFWmonitor* monitor) {
+    monitorDirty = true;
+    GLFWvidmode desktop;
+    if(monitor && monitor == modesetMonitor && glfwGetWindowMonitor(window) == monitor) {
+        // Our exclusive mode is still set, the current video mode of the monitor is not the desktop mode
+        desktop = desktopMode;
+    } else {
+        const GLFWvidmode* current = monitor ? glfwGetVideoMode(monitor) : nullptr;
+        if(current == nullptr) {
+            // No monitor to go fullscreen on, stay windowed and complete the request
+            requestFullscreen = false;
+            if(!getFullscreen())
+                onFullscreenChanged(false);
+            return;
+        }
+        desktop = *current;
+    }
+    if(fullscreenType == FullscreenType::EXCLUSIVE && mode.id != -1 && GLFWMonitorCache::isValidMode(monitor, mode)) {
+        auto& m = GLFWMonitorCache::getModes(monitor)[mode.id];
+        desktopMode = desktop;
+        modesetMonitor = monitor;
+        glfwSetWindowAttrib(window, GLFW_AUTO_ICONIFY, GLFW_TRUE);
+        glfwSetWindowMonitor(window, monitor, 0, 0, m.width, m.height, (int) m.refreshRate);
+        return;
+    }
+    modesetMonitor = nullptr;
+    // Requesting the current video mode doesn't trigger a modeset, on X11 glfw also sets _NET_WM_BYPASS_COMPOSITOR
+    // Keep the window on the monitor on focus loss, there is no video mode to restore
+    glfwSetWindowAttrib(window, GLFW_AUTO_ICONIFY, fullscreenType == FullscreenType::EXCLUSIVE ? GLFW_TRUE : GLFW_FALSE);
+    glfwSetWindowMonitor(window, monitor, 0, 0, desktop.width, desktop.height, desktop.refreshRate);
+}
+
+void GLFWGameWindow::_glfwWindowPosCallback(GLFWwindow* window, int x, int y) {
+    GLFWGameWindow* user = (GLFWGameWindow*) glfwGetWindowUserPointer(window);
+    user->monitorDirty = true;
+}
+
+void GLFWGameWindow::updateMonitor() {
+    if(!monitorDirty && monitorGeneration == GLFWMonitorCache::getGeneration())
+        return;
+    monitorDirty = false;
+    monitorGeneration = GLFWMonitorCache::getGeneration();
+    currentMonitor = GLFWMonitorCache::getMonitorForWindow(window);
+    auto mode = currentMonitor ? glfwGetVideoMode(currentMonitor) : nullptr;
+    currentRefreshRate = mode ? (float) mode->refreshRate : 0.0f;
+}
+
+GLFWmonitor* GLFWGameWindow::getTargetMonitor() {
+    if(fullscreenMonitor != -1) {
+        if(auto monitor = GLFWMonitorCache::getMonitor(fullscreenMonitor))
+            return monitor;
+    }
+    updateMonitor();
+    return currentMonitor ? currentMonitor : glfwGetPrimaryMonitor();
+}
+
+int GLFWGameWindow::getMonitor() {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    updateMonitor();
+    return GLFWMonitorCache::getMonitorId(currentMonitor);
+}
+
+void GLFWGameWindow::setFullscreenMonitor(int monitor) {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    fullscreenMonitor = monitor;
+    // Move an already fullscreen window on the next pollEvents
+    if(getFullscreen() && glfwGetWindowMonitor(window) != getTargetMonitor())
+        pendingFullscreenModeSwitch = true;
+}
+
+float GLFWGameWindow::getRefreshRate() {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    updateMonitor();
+    return currentRefreshRate;
 }
 
 void GLFWGameWindow::setFullscreenMode(const FullscreenMode& mode) {
@@ -426,29 +839,37 @@ void GLFWGameWindow::setFullscreenMode(const FullscreenMode& mode) {
     pendingFullscreenModeSwitch = true;
 }
 
+void GLFWGameWindow::setFullscreenType(FullscreenType type) {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    if(fullscreenType == type)
+        return;
+    fullscreenType = type;
+    pendingFullscreenModeSwitch = true;
+}
+
+FullscreenType GLFWGameWindow::getFullscreenType() {
+    return fullscreenType;
+}
+
 std::vector<FullscreenMode> GLFWGameWindow::getFullscreenModes() {
-    if(modes.empty()) {
-        int nModes = 0;
-        auto display = glfwGetPrimaryMonitor();
-        auto modes = glfwGetVideoModes(display, &nModes);
-        for(int j = 0; j < nModes; j++) {
-            this->modes.emplace_back(FullscreenMode { .id = j, .description = getModeDescription(modes[j])});
-        }
-    }
-    return modes;
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    return GLFWMonitorCache::getModes(getTargetMonitor());
 }
 
 FullscreenMode GLFWGameWindow::getFullscreenMode() {
-    auto display = glfwGetPrimaryMonitor();
-    int nModes;
-    auto modes = glfwGetVideoModes(display, &nModes);
-    auto mode = glfwGetVideoMode(display);
-    if(mode && modes) {
-        auto desc = getModeDescription(*mode);
-        for(int i = 0; i < nModes; i++) {
-            if(desc == getModeDescription(modes[i])) {
-                return FullscreenMode { .id = i, .description = desc};
-            }
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<TracedRecursiveMutex> lock(x11_sync);
+#endif
+    auto display = getTargetMonitor();
+    auto mode = display ? glfwGetVideoMode(display) : nullptr;
+    if(mode) {
+        int id = GLFWMonitorCache::findMode(display, *mode);
+        if(id != -1) {
+            return GLFWMonitorCache::getModes(display)[id];
         }
     }
     return FullscreenMode { -1 };
@@ -1,21 +1,29 @@
 #define EGLUT_NO_X11_INCLUDE
-#include "window_manager_eglut.h"
-#include "window_eglut.h"
+#include "native/window_manager_eglut.h"
+#include "window_manager_plugin.h"
+#include "native/window_eglut.h"
 #include "joystick_manager_linux_gamepad.h"
+#include "startup_timings.h"
+#include "gl_dispatch_cache.h"
 #include <eglut.h>
 #include <eglut_x11.h>
+#include <EGL/egl.h>
 #include <unistd.h>
 #include <linux/limits.h>
 #include <libgen.h>
 #include <cstring>
+#include <cstdio>
+#include <stdexcept>
 
-extern "C" void eglGetProcAddress();
 
 EGLUTWindowManager::EGLUTWindowManager() {
     char buf[PATH_MAX];
     memset(buf, 0, sizeof(buf));
     readlink("/proc/self/exe", buf, sizeof(buf) - 1);
     eglutInitX11ClassInstanceName(basename(buf));
+    // Starts loading the mapping database in the background while eglut connects to the display
+    LinuxGamepadJoystickManager::instance.preloadMappings();
+    StartupTimings::Scope timing("eglutInit");
     eglutInit(0, nullptr); // the args aren't really required and are troublesome to pass with this system
 }
 
@@ -23,9 +31,15 @@ GameWindowManager::ProcAddrFunc EGLUTWindowManager::getProcAddrFunc() {
     return (GameWindowManager::ProcAddrFunc) eglGetProcAddress;
 }
 
+bool EGLUTWindowManager::isPlatformExtensionSupported(const char* name) {
+    auto display = eglGetCurrentDisplay();
+    return display != EGL_NO_DISPLAY && GLDispatchCache::containsExtension(eglQueryString(display, EGL_EXTENSIONS), name);
+}
+
 std::shared_ptr<GameWindow> EGLUTWindowManager::createWindow(const std::string& title, int width, int height,
-                                                             GraphicsApi api) {
-    return std::shared_ptr<GameWindow>(new EGLUTWindow(title, width, height, api));
+                                                             GraphicsApi api, WindowOptions const& options) {
+    StartupTimings::Scope timing("createWindow");
+    return std::shared_ptr<GameWindow>(new EGLUTWindow(title, width, height, api, options));
 }
 
 void EGLUTWindowManager::addGamepadMappingFile(const std::string &path) {
@@ -36,7 +50,17 @@ void EGLUTWindowManager::addGamePadMapping(const std::string &content) {
     LinuxGamepadJoystickManager::instance.loadMappings(content);
 }
 
-#ifndef FALLBACK_EGLUT
+#ifdef GAMEWINDOW_PLUGIN
+// Entry point of the backend module, see window_manager_plugin.cpp
+GAMEWINDOW_PLUGIN_EXPORT GameWindowManager* gamewindow_create_manager() {
+    try {
+        return new EGLUTWindowManager();
+    } catch (std::exception& e) {
+        printf("EGLUTWindowManager: %s\n", e.what());
+        return nullptr;
+    }
+}
+#elif !defined(FALLBACK_EGLUT)
 // Define this window manager as the used one
 std::shared_ptr<GameWindowManager> GameWindowManager::createManager() {
     return std::shared_ptr<GameWindowManager>(new EGLUTWindowManager());
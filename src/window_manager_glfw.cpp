@@ -1,24 +1,55 @@
-#include "window_manager_glfw.h"
-#include "window_glfw.h"
+#include "native/window_manager_glfw.h"
+#include "window_manager_plugin.h"
+#include "native/window_glfw.h"
 #include "joystick_manager_glfw.h"
+#include "monitor_cache_glfw.h"
+#include "startup_timings.h"
 #include <stdexcept>
+#include <cstdio>
 
 GLFWWindowManager::GLFWWindowManager() {
     // To create a default mapping for not mapped Gamepads
     // to avoid subtracting heads from buttons again
     glfwInitHint(GLFW_JOYSTICK_HAT_BUTTONS, 0);
-    if (glfwInit() != GLFW_TRUE)
-        throw std::runtime_error("glfwInit error");
+    // Starts loading the mapping database in the background while glfw connects to the display
     GLFWJoystickManager::init();
+    {
+        StartupTimings::Scope timing("glfwInit");
+        if (glfwInit() != GLFW_TRUE)
+            throw std::runtime_error("glfwInit error");
+    }
+    GLFWMonitorCache::init();
 }
 
 GameWindowManager::ProcAddrFunc GLFWWindowManager::getProcAddrFunc() {
     return (GameWindowManager::ProcAddrFunc) glfwGetProcAddress;
 }
 
+bool GLFWWindowManager::isPlatformExtensionSupported(const char* name) {
+    // Checks the WGL, GLX or EGL extensions of the current context as well
+    return glfwGetCurrentContext() != nullptr && glfwExtensionSupported(name) == GLFW_TRUE;
+}
+
 std::shared_ptr<GameWindow> GLFWWindowManager::createWindow(const std::string& title, int width, int height,
-                                                             GraphicsApi api) {
-    return std::shared_ptr<GameWindow>(new GLFWGameWindow(title, width, height, api));
+                                                             GraphicsApi api, WindowOptions const& options) {
+    StartupTimings::Scope timing("createWindow");
+    GLFWWindowCreation creation(title, width, height, api, options);
+    while (!creation.step()) {
+    }
+    return creation.finish();
+}
+
+GameWindowManager::WindowCreationStep GLFWWindowManager::createWindowSteps(const std::string& title, int width, int height,
+                                                                          GraphicsApi api, WindowOptions const& options) {
+    std::shared_ptr<GLFWWindowCreation> creation;
+    return [creation, title, width, height, api, options]() mutable -> std::shared_ptr<GameWindow> {
+        // Created by the first step, the monitor queries have to run on the main thread as well
+        if (!creation)
+            creation = std::make_shared<GLFWWindowCreation>(title, width, height, api, options);
+        if (!creation->step())
+            return nullptr;
+        return creation->finish();
+    };
 }
 
 void GLFWWindowManager::addGamepadMappingFile(const std::string &path) {
@@ -29,7 +60,31 @@ void GLFWWindowManager::addGamePadMapping(const std::string &content) {
     GLFWJoystickManager::loadMappings(content);
 }
 
-#ifndef FALLBACK_EGLUT
+std::vector<std::string> GLFWWindowManager::getVulkanInstanceExtensions() {
+    if (glfwVulkanSupported() != GLFW_TRUE)
+        return {};
+    uint32_t count = 0;
+    const char** extensions = glfwGetRequiredInstanceExtensions(&count);
+    if (extensions == nullptr)
+        return {};
+    return std::vector<std::string>(extensions, extensions + count);
+}
+
+std::vector<MonitorInfo> GLFWWindowManager::getMonitors() {
+    return GLFWMonitorCache::getMonitors();
+}
+
+#ifdef GAMEWINDOW_PLUGIN
+// Entry point of the backend module, see window_manager_plugin.cpp
+GAMEWINDOW_PLUGIN_EXPORT GameWindowManager* gamewindow_create_manager() {
+    try {
+        return new GLFWWindowManager();
+    } catch (std::exception& e) {
+        printf("GLFWWindowManager: %s\n", e.what());
+        return nullptr;
+    }
+}
+#elif !defined(FALLBACK_EGLUT)
 // Define this window manager as the used one
 std::shared_ptr<GameWindowManager> GameWindowManager::createManager() {
     return std::shared_ptr<GameWindowManager>(new GLFWWindowManager());
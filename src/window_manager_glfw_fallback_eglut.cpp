@@ -1,5 +1,5 @@
-#include "window_manager_glfw.h"
-#include "window_manager_eglut.h"
+#include "native/window_manager_glfw.h"
+#include "native/window_manager_eglut.h"
 #include <stdexcept>
 
 static bool ReadEnvFlag(const char* name, bool def = false) {
@@ -27,9 +27,18 @@ GameWindowManager::ProcAddrFunc GLFWFallbackEGLUTWindowManager::getProcAddrFunc(
     return manager->getProcAddrFunc();
 }
 
+bool GLFWFallbackEGLUTWindowManager::isPlatformExtensionSupported(const char* name) {
+    return manager->isPlatformExtensionSupported(name);
+}
+
 std::shared_ptr<GameWindow> GLFWFallbackEGLUTWindowManager::createWindow(const std::string& title, int width, int height,
-                                                             GraphicsApi api) {
-    return manager->createWindow(title, width, height, api);
+                                                             GraphicsApi api, WindowOptions const& options) {
+    return manager->createWindow(title, width, height, api, options);
+}
+
+GameWindowManager::WindowCreationStep GLFWFallbackEGLUTWindowManager::createWindowSteps(const std::string& title, int width, int height,
+                                                                                       GraphicsApi api, WindowOptions const& options) {
+    return manager->createWindowSteps(title, width, height, api, options);
 }
 
 void GLFWFallbackEGLUTWindowManager::addGamepadMappingFile(const std::string &path) {
@@ -40,6 +49,14 @@ void GLFWFallbackEGLUTWindowManager::addGamePadMapping(const std::string &conten
     manager->addGamePadMapping(content);
 }
 
+std::vector<MonitorInfo> GLFWFallbackEGLUTWindowManager::getMonitors() {
+    return manager->getMonitors();
+}
+
+std::vector<std::string> GLFWFallbackEGLUTWindowManager::getVulkanInstanceExtensions() {
+    return manager->getVulkanInstanceExtensions();
+}
+
 // Define this window manager as the used one
 std::shared_ptr<GameWindowManager> GameWindowManager::createManager() {
     return std::shared_ptr<GameWindowManager>(new GLFWFallbackEGLUTWindowManager());
@@ -2,16 +2,26 @@
 
 #include "game_window_manager.h"
 
-class GLFWFallbackEGLUTWindowManager : public GameWindowManager {
+class GLFWFallbackEGLUTWindowManager final : public GameWindowManager {
     std::shared_ptr<GameWindowManager> manager;
 public:
     GLFWFallbackEGLUTWindowManager();
 
     ProcAddrFunc getProcAddrFunc() override;
 
-    std::shared_ptr<GameWindow> createWindow(const std::string& title, int width, int height, GraphicsApi api) override;
+    bool isPlatformExtensionSupported(const char* name) override;
+
+    using GameWindowManager::createWindow;
+
+    std::shared_ptr<GameWindow> createWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) override;
+
+    WindowCreationStep createWindowSteps(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) override;
 
     void addGamepadMappingFile(const std::string& path) override;
 
     void addGamePadMapping(const std::string &content) override;
+
+    std::vector<MonitorInfo> getMonitors() override;
+
+    std::vector<std::string> getVulkanInstanceExtensions() override;
 };
\ No newline at end of file
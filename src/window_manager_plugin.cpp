@@ -0,0 +1,59 @@
+#include "window_manager_plugin.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <dlfcn.h>
+
+#ifndef GAMEWINDOW_PLUGIN_ORDER
+#define GAMEWINDOW_PLUGIN_ORDER "glfw,eglut"
+#endif
+
+static std::string getPluginDirectory() {
+    // The modules are installed next to the core library
+    Dl_info info;
+    if (dladdr((void*) &getPluginDirectory, &info) == 0 || info.dli_fname == nullptr)
+        return std::string();
+    std::string path = info.dli_fname;
+    auto slash = path.rfind('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static void* openPlugin(std::string const& name, std::string& errors) {
+    std::string fileName = "libgamewindow-" + name + ".so";
+    void* handle = nullptr;
+    auto directory = getPluginDirectory();
+    if (!directory.empty())
+        handle = dlopen((directory + fileName).c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+        handle = dlopen(fileName.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        const char* error = dlerror();
+        errors += "\n" + name + ": " + (error ? error : "failed to load");
+    }
+    return handle;
+}
+
+// Define the plugin loader as the used window manager, only the libraries of the selected backend are loaded
+std::shared_ptr<GameWindowManager> GameWindowManager::createManager() {
+    const char* order = getenv("GAMEWINDOW_BACKENDS");
+    std::stringstream names(order != nullptr && *order ? order : GAMEWINDOW_PLUGIN_ORDER);
+    std::string name, errors;
+    while (std::getline(names, name, ',')) {
+        if (name.empty())
+            continue;
+        void* handle = openPlugin(name, errors);
+        if (handle == nullptr)
+            continue;
+        auto create = (GameWindowPluginCreateFunc) dlsym(handle, GAMEWINDOW_PLUGIN_ENTRY);
+        if (create == nullptr) {
+            errors += "\n" + name + ": missing " GAMEWINDOW_PLUGIN_ENTRY;
+            continue;
+        }
+        if (auto manager = create())
+            return std::shared_ptr<GameWindowManager>(manager);
+        // The module stays loaded, it may have started threads or registered static destructors
+        errors += "\n" + name + ": backend not available";
+    }
+    throw std::runtime_error("Failed to load a game window backend" + errors);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <game_window_manager.h>
+
+// C ABI entry point exported by every backend module, returns nullptr if the backend can't be used on this host
+#define GAMEWINDOW_PLUGIN_ENTRY "gamewindow_create_manager"
+
+using GameWindowPluginCreateFunc = GameWindowManager* (*)();
+
+#define GAMEWINDOW_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
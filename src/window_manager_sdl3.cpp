@@ -1,20 +1,43 @@
-#include "window_manager_sdl3.h"
-#include "window_sdl3.h"
+#include "native/window_manager_sdl3.h"
+#include "window_manager_plugin.h"
+#include "native/window_sdl3.h"
+#include "startup_timings.h"
+#include "gl_dispatch_cache.h"
 #include <stdexcept>
+#include <cstdio>
+#include <cstring>
 
 #include <SDL3/SDL.h>
+#include <SDL3/SDL_vulkan.h>
+#include <SDL3/SDL_egl.h>
 
 SDL3WindowManager::SDL3WindowManager() {
-    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_GAMEPAD);
+    // Unredirect fullscreen windows on X11 compositors
+    SDL_SetHint(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR, "1");
+    StartupTimings::Scope timing("SDL_Init");
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_GAMEPAD) != 0) {
+        // No display, lets the plugin loader try the next backend
+        const char* error = SDL_GetError();
+        throw std::runtime_error(std::string("SDL_Init error: ") + (error ? error : "unknown error"));
+    }
 }
 
 GameWindowManager::ProcAddrFunc SDL3WindowManager::getProcAddrFunc() {
     return (GameWindowManager::ProcAddrFunc) SDL_GL_GetProcAddress;
 }
 
+bool SDL3WindowManager::isPlatformExtensionSupported(const char* name) {
+    // GLX and WGL extensions aren't reachable through SDL, only EGL is checked
+    using QueryString = const char* (*)(SDL_EGLDisplay, EGLint);
+    auto display = SDL_EGL_GetCurrentEGLDisplay();
+    auto queryString = (QueryString) SDL_EGL_GetProcAddress("eglQueryString");
+    return display != nullptr && queryString && GLDispatchCache::containsExtension(queryString(display, EGL_EXTENSIONS), name);
+}
+
 std::shared_ptr<GameWindow> SDL3WindowManager::createWindow(const std::string& title, int width, int height,
-                                                             GraphicsApi api) {
-    return std::shared_ptr<GameWindow>(new SDL3GameWindow(title, width, height, api));
+                                                             GraphicsApi api, WindowOptions const& options) {
+    StartupTimings::Scope timing("createWindow");
+    return std::shared_ptr<GameWindow>(new SDL3GameWindow(title, width, height, api, options));
 }
 
 void SDL3WindowManager::addGamepadMappingFile(const std::string &path) {
@@ -25,7 +48,56 @@ void SDL3WindowManager::addGamePadMapping(const std::string &content) {
     SDL_AddGamepadMapping(content.data());
 }
 
+std::vector<std::string> SDL3WindowManager::getVulkanInstanceExtensions() {
+    Uint32 count = 0;
+    auto extensions = SDL_Vulkan_GetInstanceExtensions(&count);
+    if(extensions == nullptr)
+        return {};
+    return std::vector<std::string>(extensions, extensions + count);
+}
+
+std::vector<MonitorInfo> SDL3WindowManager::getMonitors() {
+    std::vector<MonitorInfo> result;
+    int count = 0;
+    auto displays = SDL_GetDisplays(&count);
+    if(!displays)
+        return result;
+    auto primary = SDL_GetPrimaryDisplay();
+    for(int i = 0; i < count; i++) {
+        MonitorInfo info;
+        info.id = (int) displays[i];
+        if(auto name = SDL_GetDisplayName(displays[i]))
+            info.name = name;
+        SDL_Rect bounds;
+        if(SDL_GetDisplayBounds(displays[i], &bounds) == 0) {
+            info.x = bounds.x;
+            info.y = bounds.y;
+            info.width = bounds.w;
+            info.height = bounds.h;
+        }
+        if(auto mode = SDL_GetCurrentDisplayMode(displays[i]))
+            info.refreshRate = mode->refresh_rate;
+        info.scale = SDL_GetDisplayContentScale(displays[i]);
+        info.primary = displays[i] == primary;
+        result.push_back(std::move(info));
+    }
+    SDL_free(displays);
+    return result;
+}
+
+#ifdef GAMEWINDOW_PLUGIN
+// Entry point of the backend module, see window_manager_plugin.cpp
+GAMEWINDOW_PLUGIN_EXPORT GameWindowManager* gamewindow_create_manager() {
+    try {
+        return new SDL3WindowManager();
+    } catch (std::exception& e) {
+        printf("SDL3WindowManager: %s\n", e.what());
+        return nullptr;
+    }
+}
+#else
 // Define this window manager as the used one
 std::shared_ptr<GameWindowManager> GameWindowManager::createManager() {
     return std::shared_ptr<GameWindowManager>(new SDL3WindowManager());
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -1,53 +1,244 @@
-#include "window_sdl3.h"
+#include "native/window_sdl3.h"
 #include "game_window_manager.h"
+#include "thread_options.h"
+#include "startup_timings.h"
+#include "diagnostics.h"
+#include "gl_debug_output.h"
+#include "monitor_cache_sdl3.h"
 
-#include <codecvt>
 #include <iomanip>
 #include <thread>
 #include <sstream>
 
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
 #include <SDL3/SDL.h>
+#include <SDL3/SDL_vulkan.h>
 
-SDL3GameWindow::SDL3GameWindow(const std::string& title, int width, int height, GraphicsApi api) :
+SDL3GameWindow::SDL3GameWindow(const std::string& title, int width, int height, GraphicsApi api, WindowOptions const& options) :
         GameWindow(title, width, height, api), width(width), height(height), windowedWidth(width), windowedHeight(height) {
     SDL_SetHint(SDL_HINT_TOUCH_MOUSE_EVENTS, "0");
     SDL_SetHint(SDL_HINT_MOUSE_TOUCH_EVENTS, "0");
+    auto& config = options.context;
+    // KHR_no_error can't be combined with debug or robust contexts
+    bool debug = config.debug || config.debugOutput;
+    bool noError = config.noError && !debug && !config.robustness;
+    int contextFlags = (debug ? SDL_GL_CONTEXT_DEBUG_FLAG : 0) | (config.robustness ? SDL_GL_CONTEXT_ROBUST_ACCESS_FLAG : 0);
     if(api == GraphicsApi::OPENGL_ES2) {
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, contextFlags);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
     } else if(api == GraphicsApi::OPENGL) {
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG | contextFlags);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
     }
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
-    SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
-    window = SDL_CreateWindow(title.data(), width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
+    SDL_GL_SetAttribute(SDL_GL_RED_SIZE, config.redBits);
+    SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, config.greenBits);
+    SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, config.blueBits);
+    SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, config.alphaBits);
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, config.depthBits);
+    SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, config.stencilBits);
+    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, config.samples > 0 ? 1 : 0);
+    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, config.samples);
+    SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, config.srgb ? 1 : 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, noError ? 1 : 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_RESET_NOTIFICATION, config.robustness ? SDL_GL_CONTEXT_RESET_LOSE_CONTEXT : SDL_GL_CONTEXT_RESET_NO_NOTIFICATION);
+    // The GL attributes are only used for SDL_WINDOW_OPENGL windows
+    SDL_WindowFlags flags = (api == GraphicsApi::VULKAN ? SDL_WINDOW_VULKAN : SDL_WINDOW_OPENGL) | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY;
+    SDL_DisplayID display = options.monitor != -1 ? (SDL_DisplayID) options.monitor : SDL_GetPrimaryDisplay();
+    if(options.fullscreen) {
+        fullscreenMonitor = options.monitor;
+        fullscreenType = options.fullscreenType;
+        mode = options.mode;
+        requestFullscreen = true;
+        // Stay hidden until the fullscreen mode is set, the surface is created at its final size once shown
+        flags |= SDL_WINDOW_FULLSCREEN | SDL_WINDOW_HIDDEN;
+    }
+    if(options.hiddenUntilFirstFrame) {
+        flags |= SDL_WINDOW_HIDDEN;
+    }
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, SDL_PROP_WINDOW_CREATE_TITLE_STRING, title.data());
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_CREATE_X_NUMBER, SDL_WINDOWPOS_CENTERED_DISPLAY(display));
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_CREATE_Y_NUMBER, SDL_WINDOWPOS_CENTERED_DISPLAY(display));
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, width);
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, height);
+    SDL_SetNumberProperty(props, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, flags);
+    window = SDL_CreateWindowWithProperties(props);
+    SDL_DestroyProperties(props);
     if(window == nullptr) {
         // Throw an exception, otherwise it would crash due to a nullptr without any information
         const char* error = SDL_GetError();
         throw std::runtime_error(error == nullptr ? "SDL3 failed to create a window without any error message" : error);
     }
-    context = SDL_GL_CreateContext(window);
-    if(context == nullptr) {
-        SDL_DestroyWindow(window);
-        const char* error = SDL_GetError();
-        throw std::runtime_error(error == nullptr ? "SDL3 failed to create a window context without any error message" : error);
+    if(api != GraphicsApi::VULKAN) {
+        StartupTimings::Scope timing("createContext");
+        context = SDL_GL_CreateContext(window);
+        if(context == nullptr && noError) {
+            // KHR_no_error is optional, fall back to a validating context
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, 0);
+            context = SDL_GL_CreateContext(window);
+        }
+        if(context == nullptr) {
+            SDL_DestroyWindow(window);
+            const char* error = SDL_GetError();
+            throw std::runtime_error(error == nullptr ? "SDL3 failed to create a window context without any error message" : error);
+        }
+        SDL_GL_MakeCurrent(window, context);
+        queryContextConfig(api);
+        if(config.debugOutput)
+            contextConfig.debugOutput = GLDebugOutput::install(api);
+    }
+
+    if(options.fullscreen) {
+        if(fullscreenType == FullscreenType::EXCLUSIVE && SDL3MonitorCache::isValidMode(display, mode)) {
+            SDL_SetWindowFullscreenMode(window, SDL3MonitorCache::getDisplayMode(display, mode.id));
+        }
+        if(!options.hiddenUntilFirstFrame) {
+            SDL_ShowWindow(window);
+        }
     }
-    SDL_GL_MakeCurrent(window, context);
+    waitForFirstFrame = options.hiddenUntilFirstFrame;
 
     SDL_SetHint(SDL_HINT_ENABLE_SCREEN_KEYBOARD, "0");
     SDL_StartTextInput();
     setRelativeScale();
 }
 
+// Subset of the GL enums, SDL doesn't include a GL header
+namespace GLEnum {
+    enum : unsigned int {
+        VERSION = 0x1F02, CONTEXT_FLAGS = 0x821E, CONTEXT_FLAG_DEBUG_BIT = 0x2,
+        CONTEXT_FLAG_ROBUST_ACCESS_BIT = 0x4, CONTEXT_FLAG_NO_ERROR_BIT = 0x8,
+        RESET_NOTIFICATION_STRATEGY = 0x8256, LOSE_CONTEXT_ON_RESET = 0x8252,
+        FRAMEBUFFER = 0x8D40, BACK_LEFT = 0x0402, BACK = 0x0405,
+        FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING = 0x8210, SRGB = 0x8C40
+    };
+}
+
+void SDL3GameWindow::queryContextConfig(GraphicsApi api) {
+    // SDL reports the requested attributes for the flags, the framebuffer sizes are the ones of the chosen config
+    int samples = 0, srgb = 0, noError = 0, flags = 0;
+    SDL_GL_GetAttribute(SDL_GL_RED_SIZE, &contextConfig.redBits);
+    SDL_GL_GetAttribute(SDL_GL_GREEN_SIZE, &contextConfig.greenBits);
+    SDL_GL_GetAttribute(SDL_GL_BLUE_SIZE, &contextConfig.blueBits);
+    SDL_GL_GetAttribute(SDL_GL_ALPHA_SIZE, &contextConfig.alphaBits);
+    SDL_GL_GetAttribute(SDL_GL_DEPTH_SIZE, &contextConfig.depthBits);
+    SDL_GL_GetAttribute(SDL_GL_STENCIL_SIZE, &contextConfig.stencilBits);
+    SDL_GL_GetAttribute(SDL_GL_MULTISAMPLESAMPLES, &samples);
+    SDL_GL_GetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, &srgb);
+    SDL_GL_GetAttribute(SDL_GL_CONTEXT_NO_ERROR, &noError);
+    SDL_GL_GetAttribute(SDL_GL_CONTEXT_FLAGS, &flags);
+    contextConfig.samples = samples;
+    contextConfig.srgb = srgb != 0;
+    contextConfig.noError = noError != 0;
+    contextConfig.debug = (flags & SDL_GL_CONTEXT_DEBUG_FLAG) != 0;
+    contextConfig.robustness = (flags & SDL_GL_CONTEXT_ROBUST_ACCESS_FLAG) != 0;
+
+    // Ask the context what it actually got, like glfw does
+    using GetString = const unsigned char* (*)(unsigned int);
+    using GetIntegerv = void (*)(unsigned int, int*);
+    using GetFramebufferAttachmentParameteriv = void (*)(unsigned int, unsigned int, unsigned int, int*);
+    using GetError = unsigned int (*)();
+    auto getString = (GetString) SDL_GL_GetProcAddress("glGetString");
+    auto getIntegerv = (GetIntegerv) SDL_GL_GetProcAddress("glGetIntegerv");
+    auto getAttachmentParameter = (GetFramebufferAttachmentParameteriv) SDL_GL_GetProcAddress("glGetFramebufferAttachmentParameteriv");
+    auto getError = (GetError) SDL_GL_GetProcAddress("glGetError");
+    if(getString == nullptr || getIntegerv == nullptr || getError == nullptr)
+        return;
+    // The version string is valid in every context, unlike GL_MAJOR_VERSION which invalid calls in KHR_no_error contexts can't probe
+    auto version = (const char*) getString(GLEnum::VERSION);
+    if(version == nullptr)
+        return;
+    bool es = strncmp(version, "OpenGL ES ", 10) == 0;
+    int major = 0, minor = 0;
+    sscanf(es ? version + 10 : version, "%d.%d", &major, &minor);
+    // GL_CONTEXT_FLAGS is core since OpenGL 3.0 and OpenGL ES 3.2
+    if(es ? (major > 3 || (major == 3 && minor >= 2)) : major >= 3) {
+        int contextFlags = 0;
+        getIntegerv(GLEnum::CONTEXT_FLAGS, &contextFlags);
+        contextConfig.noError = (contextFlags & GLEnum::CONTEXT_FLAG_NO_ERROR_BIT) != 0;
+        contextConfig.debug = (contextFlags & GLEnum::CONTEXT_FLAG_DEBUG_BIT) != 0;
+        int strategy = 0;
+        if(es || major > 4 || (major == 4 && minor >= 5))
+            getIntegerv(GLEnum::RESET_NOTIFICATION_STRATEGY, &strategy);
+        contextConfig.robustness = strategy == GLEnum::LOSE_CONTEXT_ON_RESET || (contextFlags & GLEnum::CONTEXT_FLAG_ROBUST_ACCESS_BIT) != 0;
+    }
+    if(major >= 3 && getAttachmentParameter != nullptr) {
+        int encoding = 0;
+        getAttachmentParameter(GLEnum::FRAMEBUFFER, api == GraphicsApi::OPENGL ? GLEnum::BACK_LEFT : GLEnum::BACK, GLEnum::FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING, &encoding);
+        contextConfig.srgb = encoding == GLEnum::SRGB;
+    }
+    // Don't leave errors of the unsupported queries to the application
+    while(getError() != 0) {
+    }
+}
+
+ContextConfig SDL3GameWindow::getContextConfig() {
+    return contextConfig;
+}
+
+std::shared_ptr<GameWindowContext> SDL3GameWindow::createSharedContext() {
+    if(context == nullptr)
+        return nullptr;
+    // SDL shares with the current context, make the window context current for the creation
+    auto previousWindow = SDL_GL_GetCurrentWindow();
+    auto previousContext = SDL_GL_GetCurrentContext();
+    SDL_Window* hidden = SDL_CreateWindow("", 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext shared = nullptr;
+    if(hidden && SDL_GL_MakeCurrent(window, context) == 0) {
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+        shared = SDL_GL_CreateContext(hidden);
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    }
+    if(shared == nullptr) {
+        const char* error = SDL_GetError();
+        Diagnostics::report(DiagnosticCode::SHARED_CONTEXT, DiagnosticSeverity::FAILURE, "SDL3", std::string("Failed to create a shared context: ") + (error ? error : "unknown error"));
+        if(hidden)
+            SDL_DestroyWindow(hidden);
+        SDL_GL_MakeCurrent(previousWindow, previousContext);
+        return nullptr;
+    }
+    // The new context is current, the callback is per context
+    if(contextConfig.debugOutput) {
+        int profile = 0;
+        SDL_GL_GetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, &profile);
+        GLDebugOutput::install(profile == SDL_GL_CONTEXT_PROFILE_ES ? GraphicsApi::OPENGL_ES2 : GraphicsApi::OPENGL);
+    }
+    SDL_GL_MakeCurrent(previousWindow, previousContext);
+    return std::make_shared<SDL3SharedContext>(hidden, shared);
+}
+
+uint64_t SDL3GameWindow::createVulkanSurface(void* instance) {
+    VkSurfaceKHR surface = 0;
+    if(!SDL_Vulkan_CreateSurface(window, (VkInstance) instance, nullptr, &surface)) {
+        const char* error = SDL_GetError();
+        Diagnostics::report(DiagnosticCode::VULKAN_SURFACE, DiagnosticSeverity::FAILURE, "SDL3", std::string("Failed to create a vulkan surface: ") + (error ? error : "unknown error"));
+        return 0;
+    }
+    return (uint64_t) surface;
+}
+
+SDL3SharedContext::~SDL3SharedContext() {
+    SDL_GL_DeleteContext(context);
+    SDL_DestroyWindow(window);
+}
+
+void SDL3SharedContext::makeCurrent(bool active) {
+    SDL_GL_MakeCurrent(active ? window : nullptr, active ? context : nullptr);
+}
+
 void SDL3GameWindow::makeCurrent(bool c) {
-    SDL_GL_MakeCurrent(window, c ? context : nullptr);
+    GameWindowTrace::Scope trace("makeCurrent");
+    if (c)
+        ThreadOptionsManager::apply(ThreadRole::RENDER);
+    if(context)
+        SDL_GL_MakeCurrent(window, c ? context : nullptr);
 }
 
 SDL3GameWindow::~SDL3GameWindow() {
@@ -85,6 +276,11 @@ void SDL3GameWindow::getWindowSize(int& width, int& height) const {
 }
 
 void SDL3GameWindow::show() {
+    StartupTimings::MilestoneScope timing(StartupTimings::Milestone::FIRST_SHOW);
+    if(waitForFirstFrame) {
+        showPending = true;
+        return;
+    }
     SDL_ShowWindow(window);
 }
 
@@ -172,28 +368,35 @@ static int getMouseButton(int btn) {
     }
 }
 
-static std::string getModeDescription(const SDL_DisplayMode* mode) {
-    std::stringstream desc;
-    desc << mode->w << "x" << mode->h << " @ " << mode->refresh_rate << " * " << mode->pixel_density;
-    return desc.str();
-}
-
 void SDL3GameWindow::pollEvents() {
+    ThreadOptionsManager::apply(ThreadRole::EVENTS);
+    GameWindowTrace::Scope trace("pollEvents");
+    StatsTimer statsTiming(*this, TimedStat::POLL_EVENTS);
+    if(showPending && !waitForFirstFrame) {
+        showPending = false;
+        SDL_ShowWindow(window);
+    }
     if(requestFullscreen != getFullscreen()) {
+        auto target = getTargetDisplay();
+        if(requestFullscreen && target != SDL_GetDisplayForWindow(window)) {
+            // Fullscreen windows cover the display they are on
+            SDL_SetWindowPosition(window, SDL_WINDOWPOS_CENTERED_DISPLAY(target), SDL_WINDOWPOS_CENTERED_DISPLAY(target));
+        }
         SDL_SetWindowFullscreen(window, requestFullscreen);
     }
     if(pendingFullscreenModeSwitch) {
         pendingFullscreenModeSwitch = false;
-        int nModes = 0;
-        auto display = SDL_GetDisplayForWindow(window);
-        auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
-        if(nModes > mode.id && mode.description == getModeDescription(modes[mode.id])) {
-            SDL_SetWindowFullscreenMode(window, modes[mode.id]);
+        auto display = getTargetDisplay();
+        if(fullscreenType == FullscreenType::BORDERLESS) {
+            // Desktop fullscreen, no modeset
+            SDL_SetWindowFullscreenMode(window, nullptr);
+        } else if(SDL3MonitorCache::isValidMode(display, mode)) {
+            SDL_SetWindowFullscreenMode(window, SDL3MonitorCache::getDisplayMode(display, mode.id));
         }
-        SDL_free(modes);
     }
     SDL_Event ev;
     while(SDL_PollEvent(&ev)) {
+        SDL3MonitorCache::handleEvent(ev);
         switch (ev.type)
         {
         case SDL_EVENT_MOUSE_MOTION:
@@ -243,6 +446,7 @@ void SDL3GameWindow::pollEvents() {
                 }
             }
             if(SDL_GetModState() & SDL_KMOD_CTRL && ev.key.keysym.sym == SDLK_v) {
+                StatsCounters::increment(stats.clipboardRoundTrips);
                 auto str = SDL_GetClipboardText();
                 onPaste(str);
                 SDL_free(str);
@@ -269,12 +473,13 @@ void SDL3GameWindow::pollEvents() {
         case SDL_EVENT_TEXT_INPUT:
             onKeyboardText(ev.text.text ? ev.text.text : "");
             break;
+        case SDL_EVENT_WINDOW_ENTER_FULLSCREEN:
+        case SDL_EVENT_WINDOW_LEAVE_FULLSCREEN:
+            onFullscreenChanged(ev.type == SDL_EVENT_WINDOW_ENTER_FULLSCREEN);
+            break;
         case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
             onClose();
             break;
-        case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
-            modes.clear();
-            break;
         default:
             break;
         }
@@ -294,33 +499,54 @@ void SDL3GameWindow::setFullscreenMode(const FullscreenMode& mode) {
     pendingFullscreenModeSwitch = true;
 }
 
+void SDL3GameWindow::setFullscreenType(FullscreenType type) {
+    if(fullscreenType == type)
+        return;
+    fullscreenType = type;
+    pendingFullscreenModeSwitch = true;
+}
+
+FullscreenType SDL3GameWindow::getFullscreenType() {
+    return fullscreenType;
+}
+
 FullscreenMode SDL3GameWindow::getFullscreenMode() {
-    auto display = SDL_GetDisplayForWindow(window);
-    int nModes;
-    auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
+    auto display = getTargetDisplay();
     auto mode = SDL_GetWindowFullscreenMode(window);
-    if(mode && modes) {
-        auto desc = getModeDescription(mode);
-        for(int i = 0; i < nModes; i++) {
-            if(desc == getModeDescription(modes[i])) {
-                return FullscreenMode { .id = i, .description = desc};
-            }
+    if(mode) {
+        int id = SDL3MonitorCache::findMode(display, *mode);
+        if(id != -1) {
+            return SDL3MonitorCache::getModes(display)[id];
         }
     }
     return FullscreenMode { -1 };
 }
 
 std::vector<FullscreenMode> SDL3GameWindow::getFullscreenModes() {
-    if(modes.empty()) {
-        int nModes = 0;
-        auto display = SDL_GetDisplayForWindow(window);
-        auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
-        for(int j = 0; j < nModes; j++) {
-            this->modes.emplace_back(FullscreenMode { .description = getModeDescription(modes[j]), .id = j });
-        }
-        SDL_free(modes);
+    return SDL3MonitorCache::getModes(getTargetDisplay());
+}
+
+SDL_DisplayID SDL3GameWindow::getTargetDisplay() {
+    if(fullscreenMonitor != -1)
+        return (SDL_DisplayID) fullscreenMonitor;
+    return SDL_GetDisplayForWindow(window);
+}
+
+int SDL3GameWindow::getMonitor() {
+    return (int) SDL_GetDisplayForWindow(window);
+}
+
+void SDL3GameWindow::setFullscreenMonitor(int monitor) {
+    fullscreenMonitor = monitor;
+    if(getFullscreen() && getTargetDisplay() != SDL_GetDisplayForWindow(window)) {
+        // Leave fullscreen and enter it again on the target display in pollEvents
+        SDL_SetWindowFullscreen(window, false);
     }
-    return modes;
+}
+
+float SDL3GameWindow::getRefreshRate() {
+    auto mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    return mode ? mode->refresh_rate : 0.0f;
 }
 
 bool SDL3GameWindow::getFullscreen() {
@@ -332,15 +558,27 @@ void SDL3GameWindow::setFullscreen(bool fullscreen) {
 }
 
 void SDL3GameWindow::setClipboardText(std::string const &text) {
+    StatsCounters::increment(stats.clipboardRoundTrips);
     SDL_SetClipboardText(text.data());
 }
 
 void SDL3GameWindow::swapBuffers() {
-    SDL_GL_SwapWindow(window);
+    ThreadOptionsManager::apply(ThreadRole::RENDER);
+    StartupTimings::MilestoneScope timing(StartupTimings::Milestone::FIRST_SWAP_BUFFERS);
+    GameWindowTrace::Scope trace("swapBuffers");
+    StatsTimer statsTiming(*this, TimedStat::SWAP_BUFFERS);
+    FrameTimer frameTiming(*this);
+    if(context)
+        SDL_GL_SwapWindow(window);
+    if(contextConfig.debugOutput)
+        GLDebugOutput::flushRepeats();
+    // The window is shown by the next pollEvents, it may be called from another thread
+    waitForFirstFrame = false;
 }
 
 void SDL3GameWindow::setSwapInterval(int interval) {
-    SDL_GL_SetSwapInterval(interval);
+    if(context)
+        SDL_GL_SetSwapInterval(interval);
 }
 
 void SDL3GameWindow::startTextInput() {
@@ -0,0 +1,56 @@
+#include "window_stats.h"
+
+#include <algorithm>
+
+std::mutex WindowStats::mutex;
+std::vector<GameWindow*> WindowStats::windows;
+GameWindowStats WindowStats::retired;
+
+void WindowStats::accumulate(GameWindowStats& total, GameWindowStats const& stats) {
+    for (int i = 0; i < (int) EventCategory::COUNT; i++) {
+        total.events[i] += stats.events[i];
+        total.eventsPerSecond[i] += stats.eventsPerSecond[i];
+    }
+    total.skippedCallbacks += stats.skippedCallbacks;
+    total.pollEventsCalls += stats.pollEventsCalls;
+    total.pollEventsTotalMs += stats.pollEventsTotalMs;
+    total.pollEventsMaxMs = std::max(total.pollEventsMaxMs, stats.pollEventsMaxMs);
+    total.swapBuffersCalls += stats.swapBuffersCalls;
+    total.swapBuffersTotalMs += stats.swapBuffersTotalMs;
+    total.swapBuffersMaxMs = std::max(total.swapBuffersMaxMs, stats.swapBuffersMaxMs);
+    total.gamepadPolls += stats.gamepadPolls;
+    total.gamepadMappingMisses += stats.gamepadMappingMisses;
+    total.clipboardRoundTrips += stats.clipboardRoundTrips;
+    total.cpuFrames += stats.cpuFrames;
+    total.cpuFrameTotalMs += stats.cpuFrameTotalMs;
+    total.cpuFrameMaxMs = std::max(total.cpuFrameMaxMs, stats.cpuFrameMaxMs);
+    total.gpuFrames += stats.gpuFrames;
+    total.gpuFrameTotalMs += stats.gpuFrameTotalMs;
+    total.gpuFrameMaxMs = std::max(total.gpuFrameMaxMs, stats.gpuFrameMaxMs);
+    total.gpuFramesCpuTotalMs += stats.gpuFramesCpuTotalMs;
+}
+
+void WindowStats::add(GameWindow* window) {
+    std::lock_guard<std::mutex> lock(mutex);
+    windows.push_back(window);
+}
+
+void WindowStats::remove(GameWindow* window) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find(windows.begin(), windows.end(), window);
+    if (it == windows.end())
+        return;
+    windows.erase(it);
+    auto stats = window->getStats();
+    // A destroyed window has no current rate
+    std::fill(std::begin(stats.eventsPerSecond), std::end(stats.eventsPerSecond), 0.0f);
+    accumulate(retired, stats);
+}
+
+GameWindowStats WindowStats::get() {
+    std::lock_guard<std::mutex> lock(mutex);
+    GameWindowStats total = retired;
+    for (auto window : windows)
+        accumulate(total, window->getStats());
+    return total;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <game_window.h>
+#include <mutex>
+#include <vector>
+
+// Live windows and the totals of destroyed ones, see GameWindowManager::getStats
+class WindowStats {
+
+private:
+    static std::mutex mutex;
+    static std::vector<GameWindow*> windows;
+    static GameWindowStats retired;
+
+    static void accumulate(GameWindowStats& total, GameWindowStats const& stats);
+
+public:
+    static void add(GameWindow* window);
+
+    static void remove(GameWindow* window);
+
+    static GameWindowStats get();
+
+};
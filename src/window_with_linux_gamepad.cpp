@@ -1,4 +1,4 @@
-#include "window_with_linux_gamepad.h"
+#include "native/window_with_linux_gamepad.h"
 #include "joystick_manager_linux_gamepad.h"
 
 WindowWithLinuxJoystick::WindowWithLinuxJoystick(std::string const& title, int width, int height, GraphicsApi api) :
@@ -15,4 +15,8 @@ void WindowWithLinuxJoystick::addWindowToGamepadManager() {
 
 void WindowWithLinuxJoystick::updateGamepad() {
     LinuxGamepadJoystickManager::instance.update(this);
+}
+
+void WindowWithLinuxJoystick::dispatchGamepadEvents() {
+    LinuxGamepadJoystickManager::instance.dispatchQueuedEvents();
 }
\ No newline at end of file
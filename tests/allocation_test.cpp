@@ -0,0 +1,190 @@
+// Steady state allocation test: after the window is set up, simulated frames of pollEvents and
+// swapBuffers through the event callbacks, stats, frame trace and diagnostics must not allocate
+// on the calling thread. The diagnostics thread formats and delivers the reports and may allocate
+#include <game_window.h>
+#include <game_window_manager.h>
+#include "native/frame_trace.h"
+#include "hitch_watchdog.h"
+#include "diagnostics.h"
+#include "window_stats.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static thread_local bool counting = false;
+static std::atomic<uint64_t> allocations {0};
+
+static void countAllocation() {
+    if (counting)
+        allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    countAllocation();
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+#ifdef __GLIBC__
+// Catches the C allocations as well, operator new above is counted twice which doesn't matter for zero
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+extern "C" void* malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+    countAllocation();
+    return __libc_realloc(p, size);
+}
+#endif
+
+// Stands in for a backend, generates a typical mix of events per frame
+class TestWindow : public GameWindow {
+
+private:
+    // Text events of the backends are short enough for the small string buffer
+    std::string text = "a";
+    int frame = 0;
+
+public:
+    TestWindow() : GameWindow("test", 640, 480, GraphicsApi::VULKAN) {}
+
+    void makeCurrent(bool) override {}
+    void setIcon(std::string const&) override {}
+    void show() override {}
+    void close() override {}
+    void setCursorDisabled(bool) override {}
+    bool getCursorDisabled() override { return false; }
+    bool getFullscreen() override { return false; }
+    void setFullscreen(bool) override {}
+    void getWindowSize(int& width, int& height) const override { width = 640; height = 480; }
+    void setClipboardText(std::string const&) override {}
+    void setSwapInterval(int) override {}
+
+    void pollEvents() override {
+        GameWindowTrace::Scope trace("pollEvents");
+        StatsTimer statsTiming(*this, TimedStat::POLL_EVENTS);
+        frame++;
+        onMousePosition(frame % 640, frame % 480);
+        onMouseRelativePosition(1.0, -1.0);
+        onMouseButton(10.0, 10.0, 1, frame % 2 ? MouseButtonAction::PRESS : MouseButtonAction::RELEASE);
+        onMouseScroll(10.0, 10.0, 0.0, 1.0);
+        onKeyboard(KeyCode::A, frame % 2 ? KeyAction::PRESS : KeyAction::RELEASE);
+        onKeyboardText(text);
+        onTouchStart(0, 1.0, 1.0);
+        onTouchUpdate(0, 2.0, 2.0);
+        onTouchEnd(0, 2.0, 2.0);
+        onGamepadButton(0, GamepadButtonId::A, frame % 2 != 0);
+        onGamepadAxis(0, GamepadAxisId::LEFT_X, 0.5f, GameWindowTrace::now());
+        onWindowSizeChanged(640, 480);
+        // Rate limited reports, most of them are only counted
+        Diagnostics::report(DiagnosticCode::THREAD_OPTIONS, DiagnosticSeverity::VERBOSE, "Test", "steady state report");
+    }
+
+    void swapBuffers() override {
+        GameWindowTrace::Scope trace("swapBuffers");
+        StatsTimer statsTiming(*this, TimedStat::SWAP_BUFFERS);
+        FrameTimer frameTiming(*this);
+    }
+
+};
+
+class SilentErrorHandler : public GameWindowErrorHandler {
+
+public:
+    std::atomic<uint64_t> diagnostics {0};
+
+    void onDiagnostic(GameWindowDiagnostic const&) override {
+        diagnostics.fetch_add(1, std::memory_order_relaxed);
+    }
+
+};
+
+static void runFrames(TestWindow& window, int frames) {
+    for (int i = 0; i < frames; i++) {
+        window.pollEvents();
+        window.swapBuffers();
+        GameWindowStats stats = window.getStats();
+        GameWindowStats total = WindowStats::get();
+        (void) stats;
+        (void) total;
+    }
+}
+
+int main() {
+    auto handler = std::make_shared<SilentErrorHandler>();
+    Diagnostics::setHandler(handler);
+    Diagnostics::setRateLimit(DiagnosticCode::THREAD_OPTIONS, 1.0);
+
+    TestWindow window;
+    window.setMouseButtonCallback([](double, double, int, MouseButtonAction) {});
+    window.setMousePositionCallback([](double, double) {});
+    window.setMouseRelativePositionCallback([](double, double) {});
+    window.setMouseScrollCallback([](double, double, double, double) {});
+    window.setKeyboardCallback([](KeyCode, KeyAction) {});
+    window.setKeyboardTextCallback([](std::string const&) {});
+    window.setTouchStartCallback([](int, double, double) {});
+    window.setTouchUpdateCallback([](int, double, double) {});
+    window.setTouchEndCallback([](int, double, double) {});
+    window.setGamepadButtonCallback([](int, GamepadButtonId, bool) {});
+    window.setGamepadAxisCallback([](int, GamepadAxisId, float) {});
+    window.setWindowSizeCallback([](int, int) {});
+
+    // The first report starts the diagnostics thread
+    runFrames(window, 10);
+
+    // Every trace point is a hitch, the reports are formatted on the diagnostics thread
+    WatchdogOptions watchdog;
+    watchdog.thresholdMs = 0.000001;
+    watchdog.minReportIntervalMs = 0.0;
+    HitchWatchdog::setOptions(watchdog);
+    // The buffer of this thread is taken on its first record within the measured frames
+    FrameTrace::setRecording(true);
+
+    const int frames = 10000;
+    counting = true;
+    runFrames(window, frames);
+    counting = false;
+
+    Diagnostics::flush();
+    FrameTrace::setRecording(false);
+    HitchWatchdog::setOptions(WatchdogOptions());
+
+    uint64_t count = allocations.load();
+    printf("%llu allocations in %d frames, %llu diagnostics delivered\n", (unsigned long long) count, frames,
+           (unsigned long long) handler->diagnostics.load());
+    return count == 0 ? 0 : 1;
+}